@@ -0,0 +1,358 @@
+#ifndef ADAPTIVE_SORT_
+#define ADAPTIVE_SORT_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Runs shorter than this are extended by insertion sort before they
+ * are merged.
+ */
+constexpr std::ptrdiff_t adaptive_min_run = 32;
+
+/**
+ * @brief Reverse the descending range `[first, last)` stably.
+ *
+ * After reversing the whole range, every group of equal values is reversed
+ * again, so equal values keep their relative order. `on_group(begin, end)` is
+ * called for the positions of every reversed range, so that an index can be
+ * reversed alongside.
+ */
+template <typename RandomIt, typename Compare, typename OnGroup>
+void reverse_descending(RandomIt first,
+                        RandomIt last,
+                        Compare cmp,
+                        OnGroup on_group)
+{
+    std::reverse(first, last);
+    on_group(first, last);
+
+    while (first != last)
+    {
+        RandomIt group_end = first + 1;
+        while (group_end != last && !cmp(*first, *group_end))
+            ++group_end;
+
+        if (group_end - first > 1)
+        {
+            std::reverse(first, group_end);
+            on_group(first, group_end);
+        }
+        first = group_end;
+    }
+}
+
+/**
+ * @brief End of the run starting at `first`. A descending run is reversed
+ * stably, so the result is always ascending.
+ */
+template <typename RandomIt, typename Compare>
+RandomIt find_run(RandomIt first, RandomIt last, Compare cmp)
+{
+    RandomIt run_end = first + 1;
+    if (run_end == last)
+        return run_end;
+
+    if (cmp(*run_end, *first))
+    {
+        while (run_end != last && !cmp(run_end[-1], *run_end))
+            ++run_end;
+        reverse_descending(first, run_end, cmp, [](RandomIt, RandomIt) {});
+    }
+    else
+    {
+        while (run_end != last && !cmp(*run_end, run_end[-1]))
+            ++run_end;
+    }
+
+    return run_end;
+}
+
+/**
+ * @brief Extend the sorted run `[first, sorted_end)` to `[first, last)` by
+ * stable binary insertion sort.
+ */
+template <typename RandomIt, typename Compare>
+void extend_run(RandomIt first,
+                RandomIt sorted_end,
+                RandomIt last,
+                Compare cmp)
+{
+    for (RandomIt i = sorted_end; i != last; ++i)
+    {
+        RandomIt position = std::upper_bound(first, i, *i, cmp);
+        std::rotate(position, i, i + 1);
+    }
+}
+
+/**
+ * @brief Power of the boundary between the adjacent runs `[begin_a, begin_b)`
+ * and `[begin_b, end_b)` in an input of `length` values.
+ *
+ * The power is the depth of the boundary in the perfectly balanced merge tree
+ * over `[0, length)`, computed from the midpoints of both runs as in
+ * Powersort by Munro and Wild.
+ */
+inline int node_power(std::ptrdiff_t begin_a,
+                      std::ptrdiff_t begin_b,
+                      std::ptrdiff_t end_b,
+                      std::ptrdiff_t length)
+{
+    // Twice the midpoints of both runs, compared bit by bit after dividing by
+    // length.
+    std::ptrdiff_t a = begin_a + begin_b;
+    std::ptrdiff_t b = begin_b + end_b;
+
+    int power = 0;
+    while (true)
+    {
+        ++power;
+        if (a >= length)
+        {
+            a -= length;
+            b -= length;
+        }
+        else if (b >= length)
+        {
+            break;
+        }
+        a *= 2;
+        b *= 2;
+    }
+
+    return power;
+}
+
+/**
+ * @brief Stable merge of the adjacent sorted ranges `[first, middle)` and
+ * `[middle, last)`.
+ *
+ * Values of the left range which are already in place and values of the right
+ * range which are already in place are skipped by binary search first, so
+ * merging runs that barely overlap costs little more than the searches. The
+ * rest of the left range is moved into `buffer`.
+ */
+template <typename RandomIt, typename Buffer, typename Compare>
+void merge_runs(RandomIt first,
+                RandomIt middle,
+                RandomIt last,
+                Buffer & buffer,
+                Compare cmp)
+{
+    first = std::upper_bound(first, middle, *middle, cmp);
+    if (first == middle)
+        return;
+    last = std::lower_bound(middle, last, middle[-1], cmp);
+
+    buffer.clear();
+    std::move(first, middle, std::back_inserter(buffer));
+
+    auto left = buffer.begin();
+    RandomIt right = middle;
+    RandomIt out = first;
+    while (left != buffer.end() && right != last)
+    {
+        if (cmp(*right, *left))
+            *out++ = std::move(*right++);
+        else
+            *out++ = std::move(*left++);
+    }
+    std::move(left, buffer.end(), out);
+}
+
+/**
+ * @brief Powersort of `[first, last)`.
+ *
+ * Natural runs are detected from left to right. Each run is pushed on a stack
+ * together with the power of its boundary to the previous run. Boundaries on
+ * the stack which are deeper than the boundary to a new run are merged
+ * first. This merges runs in a nearly optimal order for the given run lengths,
+ * so `r` runs are sorted in `O(n log r)` time.
+ */
+template <typename RandomIt, typename Compare>
+void powersort(RandomIt first, RandomIt last, Compare cmp)
+{
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    struct run
+    {
+        std::ptrdiff_t begin;
+        std::ptrdiff_t end;
+        int power;
+    };
+
+    std::ptrdiff_t length = last - first;
+    std::vector<run> runs;
+    std::vector<value_type> buffer;
+
+    auto next_run = [first, last, length, &cmp](std::ptrdiff_t begin)
+    {
+        std::ptrdiff_t end = find_run(first + begin, last, cmp) - first;
+        if (end - begin < adaptive_min_run)
+        {
+            std::ptrdiff_t extended_end =
+              std::min(begin + adaptive_min_run, length);
+            extend_run(first + begin, first + end, first + extended_end, cmp);
+            end = extended_end;
+        }
+        return end;
+    };
+
+    run current = {0, next_run(0), 0};
+    while (current.end < length)
+    {
+        run next = {current.end, next_run(current.end), 0};
+        next.power = node_power(current.begin, next.begin, next.end, length);
+
+        // Boundaries deeper in the merge tree than the new one are merged
+        // first. current.power is the boundary between runs.back() and
+        // current.
+        while (!runs.empty() && current.power > next.power)
+        {
+            merge_runs(first + runs.back().begin, first + current.begin,
+                       first + current.end, buffer, cmp);
+            current.begin = runs.back().begin;
+            current.power = runs.back().power;
+            runs.pop_back();
+        }
+
+        runs.push_back(current);
+        current = next;
+    }
+
+    while (!runs.empty())
+    {
+        merge_runs(first + runs.back().begin, first + current.begin,
+                   first + current.end, buffer, cmp);
+        current.begin = runs.back().begin;
+        runs.pop_back();
+    }
+
+    // The buffer only grows, so its final capacity is the most it held.
+    INDEXSORT_COUNT_SCRATCH(buffer.capacity() * sizeof(value_type));
+}
+
+/**
+ * @brief Handle inputs which are a single run without moving anything more
+ * than necessary.
+ *
+ * @return `true` if the input was sorted, `false` if it consists of more than
+ * one run and still has to be sorted.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+bool sort_single_run(RandomIt1 value_begin,
+                     RandomIt1 value_end,
+                     RandomIt2 index_begin,
+                     RandomIt2 index_end,
+                     Compare cmp)
+{
+    if (std::is_sorted(value_begin, value_end, cmp))
+    {
+        std::iota(index_begin, index_end, 0);
+        return true;
+    }
+
+    auto descending = [&cmp](const auto & a, const auto & b)
+    { return cmp(b, a); };
+    if (std::is_sorted(value_begin, value_end, descending))
+    {
+        std::iota(index_begin, index_end, 0);
+        detail::reverse_descending(
+          value_begin, value_end, cmp,
+          [value_begin, index_begin](RandomIt1 first, RandomIt1 last)
+          {
+              std::reverse(index_begin + (first - value_begin),
+                           index_begin + (last - value_begin));
+          });
+        return true;
+    }
+
+    return false;
+}
+};  // namespace detail
+
+/**
+ * Stable sort which adapts to presortedness of the values, in the style of
+ * Timsort and Powersort.
+ *
+ * Sorted and descending inputs are recognized in one pass. Sorted values
+ * aren't moved at all and descending values are only reversed, and the index
+ * is generated directly. Other inputs are converted to pairs of the value and
+ * its index as in @ref vector_pair_sort and sorted by Powersort, which
+ * detects ascending and descending natural runs, extends short runs to 32
+ * values by insertion sort and merges the runs in a nearly optimal order.
+ * Inputs made of a few long runs are therefore sorted in close to linear time,
+ * while random inputs cost about as much as `std::stable_sort`.
+ *
+ * Values are never copied, so move-only types are supported.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void adaptive_sort(RandomIt1 value_begin,
+                   RandomIt1 value_end,
+                   RandomIt2 index_begin,
+                   RandomIt2 index_end,
+                   Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    {
+        // Inputs which are a single run are sorted by this scan alone.
+        INDEXSORT_PHASE("scan");
+        if (detail::sort_single_run(value_begin, value_end, index_begin,
+                                    index_end, cmp))
+            return;
+    }
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using pair_type = std::pair<value_val_type, index_val_type>;
+
+    std::vector<pair_type> conversion;
+    conversion.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(pair_type));
+
+    {
+        INDEXSORT_PHASE("convert");
+
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+            conversion.emplace_back(std::move(*i), n++);
+    }
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::powersort(conversion.begin(), conversion.end(),
+                          [&cmp](const pair_type & a, const pair_type & b)
+                          { return cmp(a.first, b.first); });
+    }
+
+    INDEXSORT_PHASE("apply");
+    using value_diff_type =
+      typename std::iterator_traits<RandomIt1>::difference_type;
+
+    for (value_diff_type i = 0; i < length; ++i)
+    {
+        value_begin[i] = std::move(conversion[i].first);
+        index_begin[i] = conversion[i].second;
+    }
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef APPEND_SORT_
+#define APPEND_SORT_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Find the first position `p` in `[first, last)` such that `cmp(value,
+ * first[p])` holds for all of `[p, last)`, searching backwards from `last`.
+ *
+ * `[first, last)` must be sorted. The distance from `last` is found by
+ * doubling steps and then by binary search, so this takes
+ * `O(log(last - p))` comparisons. This is cheaper than plain binary search if
+ * values are inserted close to the end.
+ */
+template <typename RandomIt, typename T, typename Compare>
+RandomIt gallop_upper_bound(RandomIt first,
+                            RandomIt last,
+                            const T & value,
+                            Compare cmp)
+{
+    using diff_type = typename std::iterator_traits<RandomIt>::difference_type;
+
+    diff_type length = last - first;
+    diff_type step = 1;
+    while (step <= length && cmp(value, *(last - step)))
+        step *= 2;
+
+    // The answer is in [last - min(step, length + 1) + 1, last - step / 2].
+    RandomIt lower = step > length ? first : last - step + 1;
+    return std::upper_bound(lower, last - step / 2, value, cmp);
+}
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void append_sort_impl(RandomIt1 value_begin,
+                      RandomIt1 value_middle,
+                      RandomIt1 value_end,
+                      RandomIt2 index_begin,
+                      RandomIt2 index_end,
+                      Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using pair_type = std::pair<value_val_type, index_val_type>;
+
+    auto base_length = std::distance(value_begin, value_middle);
+
+    if (value_middle == value_end)
+        return;
+
+    // The tail is already sorted and goes after the base: nothing to merge.
+    bool tail_sorted = std::is_sorted(value_middle, value_end, cmp);
+    if (tail_sorted &&
+        (value_begin == value_middle || !cmp(*value_middle, value_middle[-1])))
+        return;
+
+    std::vector<pair_type> tail;
+    tail.reserve(static_cast<std::size_t>(length - base_length));
+    INDEXSORT_COUNT_SCRATCH((length - base_length) * sizeof(pair_type));
+
+    {
+        INDEXSORT_PHASE("sort");
+
+        for (auto i = base_length; i < length; ++i)
+            tail.emplace_back(std::move(value_begin[i]), index_begin[i]);
+
+        if (!tail_sorted)
+            detail::sort<Stable>(
+              tail.begin(), tail.end(),
+              [&cmp](const pair_type & a, const pair_type & b)
+              { return cmp(a.first, b.first); });
+    }
+
+    INDEXSORT_PHASE("apply");
+    // Merge from the back. Base values greater than the current tail value
+    // are found by galloping and moved as one block, so the base is only
+    // touched from the insertion point of the smallest tail value onwards. On
+    // ties the tail value goes after the base values, which keeps the merge
+    // stable.
+    RandomIt1 base_end = value_middle;
+    RandomIt1 out = value_end;
+    for (auto i = tail.rbegin(); i != tail.rend(); ++i)
+    {
+        RandomIt1 block =
+          gallop_upper_bound(value_begin, base_end, i->first, cmp);
+
+        if (block != base_end)
+        {
+            auto block_begin = block - value_begin;
+            auto block_end = base_end - value_begin;
+            auto out_end = out - value_begin;
+
+            std::move_backward(index_begin + block_begin,
+                               index_begin + block_end,
+                               index_begin + out_end);
+            out = std::move_backward(block, base_end, out);
+            base_end = block;
+        }
+
+        --out;
+        *out = std::move(i->first);
+        index_begin[out - value_begin] = i->second;
+    }
+}
+};  // namespace detail
+
+/**
+ * Sort values which consist of an already sorted base `[value_begin,
+ * value_middle)` followed by an unsorted tail `[value_middle, value_end)`,
+ * for example rows appended to a sorted table.
+ *
+ * The index of the base must hold the permutation of the base, the index of
+ * the tail the positions of the tail values, which is the sequence continuing
+ * from `std::distance(value_begin, value_middle)` for a table with appended
+ * rows. Only the tail is sorted, as a vector of pairs like in
+ * @ref vector_pair_sort, and then merged into the base from the back. This
+ * takes `O(k log k + n)` time for a tail of `k` values instead of the
+ * `O(n log n)` of sorting everything again, and the base is only touched from
+ * the insertion point of the smallest tail value onwards.
+ *
+ * The sort adapts to presortedness. A sorted tail isn't sorted again and a
+ * sorted tail that goes after the base isn't merged at all. Base values which
+ * go after a tail value are found by galloping, so long blocks of them are
+ * moved at once after `O(log block)` comparisons.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void append_sort(RandomIt1 value_begin,
+                 RandomIt1 value_middle,
+                 RandomIt1 value_end,
+                 RandomIt2 index_begin,
+                 RandomIt2 index_end,
+                 Compare cmp)
+{
+    detail::append_sort_impl<false>(value_begin, value_middle, value_end,
+                                    index_begin, index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref append_sort.
+ *
+ * The tail is sorted with `std::stable_sort` instead of `std::sort`. The merge
+ * puts tail values after equal base values, so if the base was sorted stably,
+ * equal values keep their original relative order in the permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_append_sort(RandomIt1 value_begin,
+                        RandomIt1 value_middle,
+                        RandomIt1 value_end,
+                        RandomIt2 index_begin,
+                        RandomIt2 index_end,
+                        Compare cmp)
+{
+    detail::append_sort_impl<true>(value_begin, value_middle, value_end,
+                                   index_begin, index_end, cmp);
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef APPLY_PERMUTATION_
+#define APPLY_PERMUTATION_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "parallel_for.hpp"
+
+namespace indexsort
+{
+/**
+ * Apply the permutation index to values in place, so that `value_begin[i]`
+ * becomes the original `value_begin[index_begin[i]]`.
+ *
+ * The permutation is decomposed into cycles. Each cycle is rotated by moving
+ * its first value into a temporary and then moving every other value of the
+ * cycle directly into its final position. This needs `length + cycles` moves
+ * instead of the `3 * length` moves of swapping. Positions that have already
+ * been placed are tracked in a bitmap of `length / 8` bytes, so the index is
+ * neither modified nor copied and no position is visited more than twice.
+ *
+ * Values are only ever moved, never copied, so move-only types are supported.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2>
+void apply_permutation(RandomIt1 value_begin,
+                       RandomIt1 value_end,
+                       RandomIt2 index_begin,
+                       RandomIt2 index_end)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using diff_type = decltype(length);
+
+    constexpr diff_type word_bits = 64;
+    std::vector<std::uint64_t> placed((length + word_bits - 1) / word_bits);
+    INDEXSORT_COUNT_SCRATCH(placed.size() * sizeof(std::uint64_t));
+
+    auto is_placed = [&placed](diff_type i)
+    { return (placed[i / word_bits] >> (i % word_bits)) & 1; };
+    auto mark_placed = [&placed](diff_type i)
+    { placed[i / word_bits] |= std::uint64_t(1) << (i % word_bits); };
+
+    for (diff_type start = 0; start < length; ++start)
+    {
+        if (is_placed(start))
+            continue;
+
+        diff_type source = static_cast<diff_type>(index_begin[start]);
+        if (source == start)
+            continue;
+
+        value_val_type temp(std::move(value_begin[start]));
+
+        diff_type target = start;
+        do
+        {
+            value_begin[target] = std::move(value_begin[source]);
+            mark_placed(target);
+            target = source;
+            source = static_cast<diff_type>(index_begin[target]);
+        } while (source != start);
+
+        value_begin[target] = std::move(temp);
+        mark_placed(target);
+    }
+}
+
+namespace detail
+{
+/**
+ * Number of index entries converted at once by @ref gather_tiles. The tile of
+ * positions stays in L1 cache while it is used for every range.
+ */
+constexpr std::ptrdiff_t permutation_tile_length = 1024;
+
+/**
+ * @brief Gathers values of one range into a buffer in permutation order and
+ * moves them back when all of them have been gathered.
+ */
+template <typename RandomIt1>
+class permutation_gather
+{
+public:
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+
+    explicit permutation_gather(RandomIt1 value_begin)
+      : value_begin_(value_begin)
+    {
+    }
+
+    void reserve(std::size_t length)
+    {
+        buffer_.reserve(length);
+    }
+
+    /**
+     * @brief Append the values at `count` positions `sources` to the buffer.
+     *
+     * Every value is moved out of the range, which is safe because a
+     * permutation reads every position exactly once.
+     */
+    template <typename Diff>
+    void gather(const Diff * sources, Diff count)
+    {
+        for (Diff i = 0; i < count; ++i)
+            buffer_.push_back(std::move(value_begin_[sources[i]]));
+    }
+
+    /**
+     * @brief Move the gathered values back into the range and free the
+     * buffer.
+     */
+    void write_back()
+    {
+        std::move(buffer_.begin(), buffer_.end(), value_begin_);
+        buffer_ = std::vector<value_val_type>();
+    }
+
+private:
+    RandomIt1 value_begin_;
+    std::vector<value_val_type> buffer_;
+};
+
+/**
+ * @brief Stream the index once in tiles and call `gather(sources, count)` for
+ * every tile.
+ */
+template <typename RandomIt2, typename Diff, typename Gather>
+void gather_tiles(RandomIt2 index_begin, Diff length, Gather gather)
+{
+    std::array<Diff, permutation_tile_length> sources;
+
+    for (Diff start = 0; start < length; start += permutation_tile_length)
+    {
+        Diff count = std::min<Diff>(permutation_tile_length, length - start);
+        for (Diff i = 0; i < count; ++i)
+            sources[i] = static_cast<Diff>(index_begin[start + i]);
+
+        gather(sources.data(), count);
+    }
+}
+
+template <typename RandomIt2, typename RandomIt1>
+void check_range_length(RandomIt2 index_begin,
+                        RandomIt2 index_end,
+                        const std::pair<RandomIt1, RandomIt1> & range)
+{
+    if (std::distance(range.first, range.second) !=
+        std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+}
+
+template <typename RandomIt2, typename... RandomIts>
+void apply_permutation_batch_impl(
+  unsigned thread_count,
+  RandomIt2 index_begin,
+  RandomIt2 index_end,
+  const std::pair<RandomIts, RandomIts> &... ranges)
+{
+    (check_range_length(index_begin, index_end, ranges), ...);
+
+    auto length = std::distance(index_begin, index_end);
+    thread_count = std::clamp(thread_count, 1u,
+                              std::max(1u, unsigned(sizeof...(RandomIts))));
+
+    // Range i is permuted by thread i % thread_count.
+    detail::parallel_for(
+      thread_count,
+      [&](unsigned thread)
+      {
+          std::tuple<permutation_gather<RandomIts>...> gathers(
+            permutation_gather<RandomIts>(ranges.first)...);
+
+          auto for_own = [thread, thread_count](auto & gathers, auto action)
+          {
+              unsigned i = 0;
+              std::apply(
+                [&](auto &... gather)
+                {
+                    ((i++ % thread_count == thread ? action(gather) : void()),
+                     ...);
+                },
+                gathers);
+          };
+
+          for_own(gathers,
+                  [length](auto & gather)
+                  { gather.reserve(static_cast<std::size_t>(length)); });
+
+          gather_tiles(index_begin, length,
+                       [&](const auto * sources, auto count)
+                       {
+                           for_own(gathers, [sources, count](auto & gather)
+                                   { gather.gather(sources, count); });
+                       });
+
+          for_own(gathers, [](auto & gather) { gather.write_back(); });
+      });
+}
+
+/**
+ * @brief Call @ref apply_permutation_batch_impl with the ranges at positions
+ * `Ranges` of `arguments`.
+ */
+template <typename RandomIt2, typename Arguments, std::size_t... Ranges>
+void apply_permutation_batch_of(unsigned thread_count,
+                                RandomIt2 index_begin,
+                                RandomIt2 index_end,
+                                const Arguments & arguments,
+                                std::index_sequence<Ranges...>)
+{
+    apply_permutation_batch_impl(thread_count, index_begin, index_end,
+                                 std::get<Ranges>(arguments)...);
+}
+};  // namespace detail
+
+/**
+ * Apply the permutation index to several ranges at once, so that
+ * `range.first[i]` becomes the original `range.first[index_begin[i]]` for
+ * every range. Ranges are passed as `std::make_pair(begin, end)` and may have
+ * different value types.
+ *
+ * Unlike @ref apply_permutation, which chases cycles one position after
+ * another, values are gathered into a temporary buffer per range. The loads of
+ * a gather don't depend on each other, so the CPU overlaps their cache misses.
+ * The index is read once in tiles and every tile is used for all ranges
+ * before the next one is read. Finally the buffers are moved back.
+ *
+ * This needs temporary memory for one copy of every range. Values are only
+ * ever moved, never copied, so move-only types are supported.
+ *
+ * @throws indexsort::length_mismatch_error If the length of any range doesn't
+ * match `std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt2, typename... RandomIts>
+void apply_permutation_batch(RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             const std::pair<RandomIts, RandomIts> &... ranges)
+{
+    detail::apply_permutation_batch_impl(1, index_begin, index_end, ranges...);
+}
+
+/**
+ * @brief @ref apply_permutation_batch with ranges distributed over threads.
+ *
+ * The ranges are followed by the number of threads to use, for example
+ * `parallel_apply_permutation_batch(index_begin, index_end, ints, strings, 2)`
+ * where `ints` and `strings` are pairs of iterators. The calling thread is one
+ * of them and their number is limited by the number of ranges. Each thread
+ * reads the index itself and permutes every `thread_count`-th range.
+ *
+ * @throws indexsort::length_mismatch_error If the length of any range doesn't
+ * match `std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt2, typename... Arguments>
+void parallel_apply_permutation_batch(RandomIt2 index_begin,
+                                      RandomIt2 index_end,
+                                      const Arguments &... arguments)
+{
+    // A parameter pack must come last to be deduced, so the thread count is
+    // split off from the ranges here.
+    constexpr std::size_t range_count = sizeof...(Arguments) - 1;
+    static_assert(sizeof...(Arguments) > 0,
+                  "parallel_apply_permutation_batch() requires the number of "
+                  "threads after the ranges.");
+
+    auto tied = std::tie(arguments...);
+    static_assert(
+      std::is_convertible_v<std::tuple_element_t<range_count, decltype(tied)>,
+                            unsigned>,
+      "parallel_apply_permutation_batch() requires the number of threads "
+      "after the ranges.");
+
+    detail::apply_permutation_batch_of(
+      static_cast<unsigned>(std::get<range_count>(tied)), index_begin,
+      index_end, tied, std::make_index_sequence<range_count>());
+}
+
+/**
+ * @brief @ref apply_permutation_batch of a list of ranges of the same type
+ * known only at runtime.
+ *
+ * @param thread_count Number of threads to use. The calling thread is one of
+ * them. It is limited by the number of ranges.
+ *
+ * @throws indexsort::length_mismatch_error If the length of any range doesn't
+ * match `std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2>
+void apply_permutation_batch(
+  RandomIt2 index_begin,
+  RandomIt2 index_end,
+  const std::vector<std::pair<RandomIt1, RandomIt1>> & ranges,
+  unsigned thread_count = 1)
+{
+    for (const auto & range : ranges)
+        detail::check_range_length(index_begin, index_end, range);
+
+    auto length = std::distance(index_begin, index_end);
+    thread_count = std::clamp(
+      thread_count, 1u, std::max(1u, static_cast<unsigned>(ranges.size())));
+
+    // Range i is permuted by thread i % thread_count.
+    detail::parallel_for(
+      thread_count,
+      [&](unsigned thread)
+      {
+          std::vector<detail::permutation_gather<RandomIt1>> gathers;
+          for (std::size_t i = thread; i < ranges.size(); i += thread_count)
+          {
+              gathers.emplace_back(ranges[i].first);
+              gathers.back().reserve(static_cast<std::size_t>(length));
+          }
+
+          detail::gather_tiles(index_begin, length,
+                               [&gathers](const auto * sources, auto count)
+                               {
+                                   for (auto & gather : gathers)
+                                       gather.gather(sources, count);
+                               });
+
+          for (auto & gather : gathers)
+              gather.write_back();
+      });
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef ARGSORT_
+#define ARGSORT_
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "ordered_key.hpp"
+#include "radix_sort.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void argsort_impl(RandomIt1 value_begin,
+                  RandomIt1 value_end,
+                  RandomIt2 index_begin,
+                  RandomIt2 index_end,
+                  [[maybe_unused]] Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    if constexpr (detail::has_ordered_key_v<value_val_type, Compare>)
+    {
+        if (length == 0)
+            return;
+
+        using sort_key = detail::sort_key<value_val_type, Compare>;
+
+        std::vector<typename sort_key::type> keys;
+        std::vector<index_val_type> index;
+        keys.reserve(length);
+        index.reserve(length);
+        // The keys and the index, and the buffers of radix_sort_keys().
+        INDEXSORT_COUNT_SCRATCH(2 * length *
+                                (sizeof(typename sort_key::type) +
+                                 sizeof(index_val_type)));
+
+        {
+            INDEXSORT_PHASE("convert");
+
+            index_val_type n = 0;
+            for (RandomIt1 i(value_begin); i != value_end; ++i)
+            {
+                keys.push_back(sort_key::to_key(*i));
+                index.push_back(n++);
+            }
+        }
+
+        {
+            INDEXSORT_PHASE("sort");
+            detail::radix_sort_keys(keys, index);
+        }
+
+        INDEXSORT_PHASE("apply");
+        std::copy(index.begin(), index.end(), index_begin);
+    }
+    else
+    {
+        // The index is sorted in place, there is nothing to apply.
+        INDEXSORT_PHASE("sort");
+        detail::sort<Stable>(
+          index_begin, index_end,
+          [&value_begin, &cmp](const index_val_type & a,
+                               const index_val_type & b)
+          { return cmp(value_begin[a], value_begin[b]); });
+    }
+}
+};  // namespace detail
+
+/**
+ * Compute the permutation index without moving any values. The values are only
+ * read, so `RandomIt1` may be a constant iterator, for example a pointer into
+ * read-only memory mapped data.
+ *
+ * Integers and IEEE floating point numbers compared by `std::less` or
+ * `std::greater` are radix sorted as in @ref radix_sort, but only the index is
+ * written back. Other values are sorted by `std::sort`ing the index with a
+ * custom comparator that uses values contents instead of index contents. This
+ * is cheaper than the other algorithms for large values, which are expensive to
+ * move.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void argsort(RandomIt1 value_begin,
+             RandomIt1 value_end,
+             RandomIt2 index_begin,
+             RandomIt2 index_end,
+             Compare cmp)
+{
+    detail::argsort_impl<false>(value_begin, value_end, index_begin,
+                                index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref argsort.
+ *
+ * Values which aren't radix sorted are sorted with `std::stable_sort` instead
+ * of `std::sort`, so equal values keep their original relative order in the
+ * permutation index. Radix sort is stable already.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_argsort(RandomIt1 value_begin,
+                    RandomIt1 value_end,
+                    RandomIt2 index_begin,
+                    RandomIt2 index_end,
+                    Compare cmp)
+{
+    detail::argsort_impl<true>(value_begin, value_end, index_begin, index_end,
+                               cmp);
+}
+};  // namespace indexsort
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef BASE_H_
 #define BASE_H_
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace indexsort
@@ -13,6 +14,29 @@ struct length_mismatch_error : public std::runtime_error
 {
     using std::runtime_error::runtime_error;
 };
+
+/**
+ * @brief Exception signalling that reading or writing a file failed.
+ */
+struct io_error : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail
+{
+/**
+ * @brief `std::stable_sort` if `Stable` is `true`, `std::sort` otherwise.
+ */
+template <bool Stable, typename RandomIt, typename Compare>
+void sort(RandomIt first, RandomIt last, Compare cmp)
+{
+    if constexpr (Stable)
+        std::stable_sort(first, last, cmp);
+    else
+        std::sort(first, last, cmp);
+}
+};  // namespace detail
 };  // namespace indexsort
 
 #endif
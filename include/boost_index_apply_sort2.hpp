@@ -3,12 +3,59 @@
 
 #include <algorithm>
 #include <boost/algorithm/apply_permutation.hpp>
+#include <memory>
 #include <vector>
 
 #include "base.hpp"
+#include "instrumentation.hpp"
 
 namespace indexsort
 {
+namespace detail
+{
+template <bool Stable,
+          typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void boost_index_apply_sort2_impl(RandomIt1 value_begin,
+                                  RandomIt1 value_end,
+                                  RandomIt2 index_begin,
+                                  RandomIt2 index_end,
+                                  Compare cmp,
+                                  const Allocator & alloc)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    using index_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<index_val_type>;
+
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(index_val_type));
+
+    std::vector<index_val_type, index_allocator> temp(index_begin, index_end,
+                                                      index_allocator(alloc));
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::sort<Stable>(temp.begin(), temp.end(),
+                             [&value_begin, &cmp](const index_val_type & a,
+                                                  const index_val_type & b)
+                             { return cmp(value_begin[a], value_begin[b]); });
+    }
+
+    INDEXSORT_PHASE("apply");
+    std::copy(temp.begin(), temp.end(), index_begin);
+
+    boost::algorithm::apply_permutation(value_begin, value_end, temp.begin(),
+                                        temp.end());
+}
+};  // namespace detail
+
 /**
  * @brief Variation of @ref boost_index_apply_sort.
  *
@@ -25,24 +72,83 @@ void boost_index_apply_sort2(RandomIt1 value_begin,
                              RandomIt2 index_end,
                              Compare cmp)
 {
-    auto length = std::distance(value_begin, value_end);
-
-    if (length != std::distance(index_begin, index_end))
-        throw length_mismatch_error("Length of both iterables must match!");
-
-    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
-
-    std::vector<index_val_type> temp(index_begin, index_end);
+    detail::boost_index_apply_sort2_impl<false>(value_begin, value_end,
+                                                index_begin, index_end, cmp,
+                                                std::allocator<char>());
+}
 
-    std::sort(
-      temp.begin(), temp.end(),
-      [&value_begin, &cmp](const index_val_type & a, const index_val_type & b)
-      { return cmp(value_begin[a], value_begin[b]); });
+/**
+ * @brief @ref boost_index_apply_sort2 which allocates its temporary buffer with
+ * `alloc`.
+ *
+ * Passing an @ref arena_allocator makes repeated calls reuse the same memory
+ * instead of allocating a new buffer every time.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void boost_index_apply_sort2(RandomIt1 value_begin,
+                             RandomIt1 value_end,
+                             RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             Compare cmp,
+                             const Allocator & alloc)
+{
+    detail::boost_index_apply_sort2_impl<false>(value_begin, value_end,
+                                                index_begin, index_end, cmp,
+                                                alloc);
+}
 
-    std::copy(temp.begin(), temp.end(), index_begin);
+/**
+ * @brief Stable variation of @ref boost_index_apply_sort2.
+ *
+ * This algorithm uses `std::stable_sort` instead of `std::sort`, so equal
+ * values keep their original relative order in the permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_boost_index_apply_sort2(RandomIt1 value_begin,
+                                    RandomIt1 value_end,
+                                    RandomIt2 index_begin,
+                                    RandomIt2 index_end,
+                                    Compare cmp)
+{
+    detail::boost_index_apply_sort2_impl<true>(value_begin, value_end,
+                                               index_begin, index_end, cmp,
+                                               std::allocator<char>());
+}
 
-    boost::algorithm::apply_permutation(value_begin, value_end, temp.begin(),
-                                        temp.end());
+/**
+ * @brief @ref stable_boost_index_apply_sort2 which allocates its temporary
+ * buffer with `alloc`.
+ *
+ * Only the copy of the index is allocated with `alloc`. `std::stable_sort`
+ * still allocates its own merge buffer on every call, so an
+ * @ref arena_allocator saves one allocation per call, not all of them.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void stable_boost_index_apply_sort2(RandomIt1 value_begin,
+                                    RandomIt1 value_end,
+                                    RandomIt2 index_begin,
+                                    RandomIt2 index_end,
+                                    Compare cmp,
+                                    const Allocator & alloc)
+{
+    detail::boost_index_apply_sort2_impl<true>(value_begin, value_end,
+                                               index_begin, index_end, cmp,
+                                               alloc);
 }
 };  // namespace indexsort
 
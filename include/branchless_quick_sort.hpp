@@ -0,0 +1,293 @@
+#ifndef BRANCHLESS_QUICK_SORT_
+#define BRANCHLESS_QUICK_SORT_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "ordered_key.hpp"
+#include "sorting_network.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Ordered key together with its index. Elements are compared by key
+ * and then by index, so no two elements of a permutation are equal.
+ */
+template <typename Key, typename Index>
+struct key_index
+{
+    Key key;
+    Index index;
+
+    // Bitwise operators instead of short-circuiting ones, so that the
+    // comparison compiles without branches.
+    bool operator<(const key_index & other) const
+    {
+        return (key < other.key) |
+               ((key == other.key) & (index < other.index));
+    }
+};
+
+/**
+ * @brief Number of elements below which @ref quick_sort_keys stops
+ * partitioning.
+ */
+constexpr std::ptrdiff_t quick_sort_threshold = sorting_network_max_length;
+
+template <typename T>
+void insertion_sort(T * first, T * last)
+{
+    for (T * i = first + 1; i < last; ++i)
+    {
+        T element = *i;
+        T * j = i;
+        for (; j > first && element < *(j - 1); --j)
+            *j = *(j - 1);
+        *j = element;
+    }
+}
+
+template <typename T>
+void sort3(T & a, T & b, T & c)
+{
+    if (b < a)
+        std::swap(a, b);
+    if (c < b)
+        std::swap(b, c);
+    if (b < a)
+        std::swap(a, b);
+}
+
+/**
+ * @brief Partition `[first, last)` around `*first` with the Lomuto scheme
+ * without data dependent branches and return the final position of the pivot.
+ *
+ * Every element is swapped with the first element not smaller than the pivot,
+ * which is harmless when the element isn't smaller than the pivot either.
+ * The pointer to that element is then advanced by the result of the
+ * comparison. The loop never mispredicts, unlike Hoare partitioning, whose
+ * branches are taken at random on random keys.
+ */
+template <typename T>
+T * branchless_partition(T * first, T * last)
+{
+    const T pivot = *first;
+
+    T * left = first + 1;
+    for (T * right = first + 1; right < last; ++right)
+    {
+        bool smaller = *right < pivot;
+        std::swap(*left, *right);
+        left += smaller;
+    }
+
+    --left;
+    std::swap(*first, *left);
+    return left;
+}
+
+/**
+ * @brief Introsort of `[first, last)` with @ref branchless_partition.
+ *
+ * The pivot is the median of three elements, or of three medians of three for
+ * long ranges. Ranges shorter than @ref quick_sort_threshold are sorted by
+ * @ref sort_network if the elements are packed keys and indexes, and by
+ * insertion sort otherwise. Ranges which exceed the recursion depth limit are
+ * heap sorted.
+ */
+template <typename T>
+void quick_sort_keys(T * first, T * last, int depth_limit)
+{
+    while (last - first > quick_sort_threshold)
+    {
+        if (depth_limit-- == 0)
+        {
+            std::make_heap(first, last);
+            std::sort_heap(first, last);
+            return;
+        }
+
+        std::ptrdiff_t length = last - first;
+        T * middle = first + length / 2;
+        if (length > 8 * quick_sort_threshold)
+        {
+            std::ptrdiff_t step = length / 8;
+            sort3(first[1], first[step], first[2 * step]);
+            sort3(middle[-step], middle[0], middle[step]);
+            sort3(last[-2 * step - 1], last[-step - 1], last[-2]);
+            sort3(first[step], middle[0], last[-step - 1]);
+        }
+        else
+        {
+            sort3(first[1], middle[0], last[-1]);
+        }
+        std::swap(*first, *middle);
+
+        T * pivot = branchless_partition(first, last);
+
+        // Recurse into the shorter part, loop on the longer one.
+        if (pivot - first < last - pivot)
+        {
+            quick_sort_keys(first, pivot, depth_limit);
+            first = pivot + 1;
+        }
+        else
+        {
+            quick_sort_keys(pivot + 1, last, depth_limit);
+            last = pivot;
+        }
+    }
+
+    if constexpr (std::is_same_v<T, std::uint64_t>)
+        sort_network(first, static_cast<std::size_t>(last - first));
+    else if (last - first > 1)
+        insertion_sort(first, last);
+}
+
+template <typename T>
+void quick_sort_keys(T * first, T * last)
+{
+    int depth_limit = 0;
+    for (std::ptrdiff_t length = last - first; length > 1; length /= 2)
+        depth_limit += 2;
+
+    quick_sort_keys(first, last, depth_limit);
+}
+};  // namespace detail
+
+/**
+ * Convert values into ordered keys (see @ref detail::ordered_key) stored
+ * together with their indexes and sort them with an introsort whose partition
+ * step doesn't branch on the keys. Keys and indexes are moved in lockstep and
+ * compared directly, without the `value_begin[a]` indirection of the
+ * algorithms which sort only the index.
+ *
+ * Keys of up to 32 bits are packed with a 32-bit index into a single
+ * `std::uint64_t` as in @ref packed_sort and short ranges are sorted with
+ * @ref detail::sort_network. Other keys are stored in a
+ * @ref detail::key_index and short ranges are insertion sorted.
+ *
+ * Because the index is compared when keys are equal, equal values keep their
+ * original relative order in the permutation index.
+ *
+ * Only integers and IEEE floating point numbers are supported. `cmp` is never
+ * called, its type is only used to determine the direction of the sort, so it
+ * must be `std::less` or `std::greater`. This algorithm doesn't read the
+ * contents of the index iterable.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void branchless_quick_sort(RandomIt1 value_begin,
+                           RandomIt1 value_end,
+                           RandomIt2 index_begin,
+                           RandomIt2 index_end,
+                           [[maybe_unused]] Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    static_assert(detail::has_ordered_key_v<value_val_type, Compare>,
+                  "branchless_quick_sort() requires integers or IEEE floating "
+                  "point numbers compared by std::less or std::greater.");
+
+    using sort_key = detail::sort_key<value_val_type, Compare>;
+    using key_type = typename sort_key::type;
+
+    using value_diff_type =
+      typename std::iterator_traits<RandomIt1>::difference_type;
+
+    detail::negative_zeros<value_val_type, index_val_type> negative_zeros;
+
+    if constexpr (sizeof(key_type) <= sizeof(std::uint32_t))
+    {
+        if (static_cast<std::uint64_t>(length) <=
+            std::numeric_limits<std::uint32_t>::max())
+        {
+            std::vector<std::uint64_t> packed;
+            packed.reserve(length);
+            INDEXSORT_COUNT_SCRATCH(length * sizeof(std::uint64_t));
+
+            {
+                INDEXSORT_PHASE("convert");
+
+                std::uint64_t n = 0;
+                for (RandomIt1 i(value_begin); i != value_end; ++i)
+                {
+                    negative_zeros.record(*i, static_cast<index_val_type>(n));
+                    packed.push_back(
+                      (static_cast<std::uint64_t>(sort_key::to_key(*i))
+                       << 32) |
+                      n++);
+                }
+            }
+
+            {
+                INDEXSORT_PHASE("sort");
+                detail::quick_sort_keys(packed.data(),
+                                        packed.data() + packed.size());
+            }
+
+            INDEXSORT_PHASE("apply");
+            for (value_diff_type i = 0; i < length; ++i)
+            {
+                value_begin[i] =
+                  sort_key::from_key(static_cast<key_type>(packed[i] >> 32));
+                index_begin[i] =
+                  static_cast<index_val_type>(packed[i] & 0xffffffffu);
+            }
+            negative_zeros.restore(value_begin, value_end, index_begin);
+            return;
+        }
+    }
+
+    using element_type = detail::key_index<key_type, index_val_type>;
+
+    std::vector<element_type> elements;
+    elements.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(element_type));
+
+    {
+        INDEXSORT_PHASE("convert");
+
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+        {
+            negative_zeros.record(*i, n);
+            elements.push_back({sort_key::to_key(*i), n++});
+        }
+    }
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::quick_sort_keys(elements.data(),
+                                elements.data() + elements.size());
+    }
+
+    INDEXSORT_PHASE("apply");
+    for (value_diff_type i = 0; i < length; ++i)
+    {
+        value_begin[i] = sort_key::from_key(elements[i].key);
+        index_begin[i] = elements[i].index;
+    }
+    negative_zeros.restore(value_begin, value_end, index_begin);
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef CYCLE_APPLY_SORT_
+#define CYCLE_APPLY_SORT_
+
+#include <algorithm>
+#include <iterator>
+
+#include "apply_permutation.hpp"
+#include "base.hpp"
+#include "instrumentation.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void cycle_apply_sort_impl(RandomIt1 value_begin,
+                           RandomIt1 value_end,
+                           RandomIt2 index_begin,
+                           RandomIt2 index_end,
+                           Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::sort<Stable>(index_begin, index_end,
+                             [&value_begin, &cmp](const index_val_type & a,
+                                                  const index_val_type & b)
+                             { return cmp(value_begin[a], value_begin[b]); });
+    }
+
+    INDEXSORT_PHASE("apply");
+    indexsort::apply_permutation(value_begin, value_end, index_begin,
+                                 index_end);
+}
+};  // namespace detail
+
+/**
+ * `std::sort` index with custom comparator that uses values contents instead of
+ * index contents. Then apply the permutation index to values with
+ * @ref apply_permutation, which moves values along the cycles of the
+ * permutation and tracks placed values in a bitmap.
+ *
+ * Unlike @ref boost_index_apply_sort, the index doesn't have to be copied,
+ * because it isn't destroyed by applying it. Unlike
+ * @ref permutate_in_place_sort, the index isn't walked repeatedly to find
+ * where values have been swapped to.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void cycle_apply_sort(RandomIt1 value_begin,
+                      RandomIt1 value_end,
+                      RandomIt2 index_begin,
+                      RandomIt2 index_end,
+                      Compare cmp)
+{
+    detail::cycle_apply_sort_impl<false>(value_begin, value_end, index_begin,
+                                         index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref cycle_apply_sort.
+ *
+ * This algorithm uses `std::stable_sort` instead of `std::sort`, so equal
+ * values keep their original relative order in the permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_cycle_apply_sort(RandomIt1 value_begin,
+                             RandomIt1 value_end,
+                             RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             Compare cmp)
+{
+    detail::cycle_apply_sort_impl<true>(value_begin, value_end, index_begin,
+                                        index_end, cmp);
+}
+};  // namespace indexsort
+
+#endif
@@ -5,9 +5,41 @@
 #include <vector>
 
 #include "base.hpp"
+#include "instrumentation.hpp"
 
 namespace indexsort
 {
+namespace detail
+{
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void double_sort_impl(RandomIt1 value_begin,
+                      RandomIt1 value_end,
+                      RandomIt2 index_begin,
+                      RandomIt2 index_end,
+                      Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::sort<Stable>(
+          index_begin, index_end,
+          [&value_begin, &cmp](const index_val_type & a,
+                               const index_val_type & b)
+          { return cmp(value_begin[a], value_begin[b]); });
+    }
+
+    // Sorting the values again puts them in the order of the index.
+    INDEXSORT_PHASE("apply");
+    detail::sort<Stable>(value_begin, value_end, cmp);
+}
+};  // namespace detail
+
 /**
  * `std::sort` index with custom comparator that uses values contents instead of
  * index contents. Then `std::sort` values directly with `cmp`.
@@ -22,18 +54,30 @@ void double_sort(RandomIt1 value_begin,
                  RandomIt2 index_end,
                  Compare cmp)
 {
-    auto length = std::distance(value_begin, value_end);
-
-    if (length != std::distance(index_begin, index_end))
-        throw length_mismatch_error("Length of both iterables must match!");
-
-    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    detail::double_sort_impl<false>(value_begin, value_end, index_begin,
+                                    index_end, cmp);
+}
 
-    std::sort(
-      index_begin, index_end,
-      [&value_begin, &cmp](const index_val_type & a, const index_val_type & b)
-      { return cmp(value_begin[a], value_begin[b]); });
-    std::sort(value_begin, value_end, cmp);
+/**
+ * @brief Stable variation of @ref double_sort.
+ *
+ * Both the index and the values are sorted with `std::stable_sort`. Equal
+ * values keep their original relative order in the permutation index and,
+ * because both sorts resolve ties the same way, every value ends up next to
+ * its own index even if equal values are distinguishable.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_double_sort(RandomIt1 value_begin,
+                        RandomIt1 value_end,
+                        RandomIt2 index_begin,
+                        RandomIt2 index_end,
+                        Compare cmp)
+{
+    detail::double_sort_impl<true>(value_begin, value_end, index_begin,
+                                   index_end, cmp);
 }
 };  // namespace indexsort
 
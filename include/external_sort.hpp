@@ -0,0 +1,464 @@
+#ifndef EXTERNAL_SORT_
+#define EXTERNAL_SORT_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "vector_pair_sort.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+struct file_closer
+{
+    void operator()(std::FILE * file) const noexcept
+    {
+        std::fclose(file);
+    }
+};
+
+/**
+ * @brief `std::FILE` closed when the handle goes out of scope.
+ */
+using file_handle = std::unique_ptr<std::FILE, file_closer>;
+
+inline file_handle open_file(const std::string & path, const char * mode)
+{
+    file_handle file(std::fopen(path.c_str(), mode));
+    if (!file)
+        throw io_error("Can't open file " + path + "!");
+    return file;
+}
+
+/**
+ * @brief Anonymous temporary file which is deleted when it's closed.
+ */
+inline file_handle temporary_file()
+{
+    file_handle file(std::tmpfile());
+    if (!file)
+        throw io_error("Can't create temporary file!");
+    return file;
+}
+
+template <typename T>
+void write_records(std::FILE * file, const T * data, std::size_t count)
+{
+    if (count != 0 && std::fwrite(data, sizeof(T), count, file) != count)
+        throw io_error("Writing to file failed!");
+}
+
+/**
+ * @brief Read up to `count` records.
+ *
+ * Bytes are counted instead of records, because `std::fread` silently drops a
+ * partial record at the end of the file. A file whose size isn't a multiple
+ * of `sizeof(T)` is reported instead of losing its last bytes.
+ */
+template <typename T>
+std::size_t read_records(std::FILE * file, T * data, std::size_t count)
+{
+    std::size_t read = std::fread(data, 1, count * sizeof(T), file);
+    if (read != count * sizeof(T) && std::ferror(file))
+        throw io_error("Reading from file failed!");
+    if (read % sizeof(T) != 0)
+        throw io_error("File ends with a partial record!");
+    return read / sizeof(T);
+}
+
+/**
+ * @brief Value together with its position in the input, as stored in runs.
+ */
+template <typename T>
+struct external_record
+{
+    T value;
+    std::uint64_t position;
+};
+
+/**
+ * @brief Buffered sequential reader of records from a run file.
+ */
+template <typename T>
+class run_reader
+{
+public:
+    run_reader(std::FILE * file, std::size_t buffer_length)
+      : file_(file), buffer_(buffer_length)
+    {
+        std::rewind(file_);
+        refill();
+    }
+
+    bool empty() const
+    {
+        return position_ == size_;
+    }
+
+    const external_record<T> & front() const
+    {
+        return buffer_[position_];
+    }
+
+    void pop()
+    {
+        if (++position_ == size_)
+            refill();
+    }
+
+private:
+    void refill()
+    {
+        size_ = read_records(file_, buffer_.data(), buffer_.size());
+        position_ = 0;
+    }
+
+    std::FILE * file_;
+    std::vector<external_record<T>> buffer_;
+    std::size_t position_ = 0;
+    std::size_t size_ = 0;
+};
+
+/**
+ * @brief Merge sorted runs into `sink` through a heap of the run readers.
+ *
+ * Records with equal values are ordered by their position in the input, so
+ * the merge is stable. `sink(record)` is called for every record in order.
+ */
+template <typename T, typename Compare, typename Sink>
+void merge_runs(const std::vector<std::FILE *> & runs,
+                std::size_t buffer_length,
+                Compare cmp,
+                Sink sink)
+{
+    INDEXSORT_PHASE("merge");
+    INDEXSORT_COUNT_SCRATCH(runs.size() * buffer_length *
+                            sizeof(external_record<T>));
+
+    std::vector<run_reader<T>> readers;
+    readers.reserve(runs.size());
+    for (std::FILE * run : runs)
+        readers.emplace_back(run, buffer_length);
+
+    // std::push_heap keeps the largest element on top, so the comparison is
+    // reversed.
+    auto heap_cmp = [&readers, &cmp](std::size_t a, std::size_t b)
+    {
+        const auto & record_a = readers[a].front();
+        const auto & record_b = readers[b].front();
+        if (cmp(record_b.value, record_a.value))
+            return true;
+        if (cmp(record_a.value, record_b.value))
+            return false;
+        return record_b.position < record_a.position;
+    };
+
+    std::vector<std::size_t> heap;
+    for (std::size_t i = 0; i < readers.size(); ++i)
+        if (!readers[i].empty())
+            heap.push_back(i);
+    std::make_heap(heap.begin(), heap.end(), heap_cmp);
+
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), heap_cmp);
+        auto & reader = readers[heap.back()];
+
+        sink(reader.front());
+        reader.pop();
+
+        if (reader.empty())
+            heap.pop_back();
+        else
+            std::push_heap(heap.begin(), heap.end(), heap_cmp);
+    }
+}
+
+/**
+ * @brief Collects records into a buffer and writes the buffer with
+ * `write(const T *, std::size_t)` whenever it fills up.
+ */
+template <typename T, typename Write>
+class buffered_writer
+{
+public:
+    buffered_writer(std::size_t buffer_length, Write write)
+      : write_(write)
+    {
+        buffer_.reserve(buffer_length);
+        INDEXSORT_COUNT_SCRATCH(buffer_length * sizeof(T));
+    }
+
+    void push(const T & element)
+    {
+        buffer_.push_back(element);
+        if (buffer_.size() == buffer_.capacity())
+            flush();
+    }
+
+    void flush()
+    {
+        write_(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+private:
+    std::vector<T> buffer_;
+    Write write_;
+};
+
+/**
+ * @brief Number of records each run is read in at least, when the memory
+ * budget allows it. It limits the number of runs merged at once.
+ */
+constexpr std::size_t external_merge_block = 4096;
+
+/**
+ * @brief Sort values produced by `source` and write them to `value_output`
+ * and their positions to `index_output`.
+ *
+ * `source(T * buffer, std::size_t length)` fills `buffer` with up to `length`
+ * next values and returns how many it wrote, 0 at the end of the input.
+ */
+template <typename T, typename Source, typename Compare>
+void external_sort_impl(Source source,
+                        std::FILE * value_output,
+                        std::FILE * index_output,
+                        Compare cmp,
+                        std::size_t memory_budget)
+{
+    using record = external_record<T>;
+
+    // Half of the budget is used for sorting runs and half for merging them.
+    // A run is held as values and positions and as the pairs made of them by
+    // vector_pair_sort, roughly two records per value.
+    std::size_t merge_budget = memory_budget / 2;
+    std::size_t run_length =
+      std::max<std::size_t>(1, memory_budget / (4 * sizeof(record)));
+
+    // Inputs of all runs merged at once and the output share the budget.
+    std::size_t fan_in = std::max<std::size_t>(
+      2, merge_budget / (sizeof(record) * external_merge_block));
+    auto block_length = [merge_budget](std::size_t buffers)
+    {
+        std::size_t length = merge_budget / (buffers * sizeof(record));
+        return std::max<std::size_t>(1, length);
+    };
+
+    auto merge_into_run = [&cmp, &block_length](
+                            const std::vector<file_handle> & runs)
+    {
+        std::vector<std::FILE *> group;
+        for (const auto & run : runs)
+            group.push_back(run.get());
+
+        file_handle merged_run = temporary_file();
+        std::FILE * run_file = merged_run.get();
+        auto write = [run_file](const record * data, std::size_t length)
+        { write_records(run_file, data, length); };
+
+        std::size_t length = block_length(group.size() + 1);
+        buffered_writer<record, decltype(write)> writer(length, write);
+        merge_runs<T>(group, length, cmp,
+                      [&writer](const record & r) { writer.push(r); });
+        writer.flush();
+
+        return merged_run;
+    };
+
+    // Runs are merged as soon as there are fan_in runs of the same level, so
+    // the number of open temporary files grows only logarithmically with the
+    // length of the input.
+    std::vector<std::vector<file_handle>> levels;
+    auto add_run = [&levels, &merge_into_run, fan_in](file_handle run)
+    {
+        for (std::size_t level = 0;; ++level)
+        {
+            if (level == levels.size())
+                levels.emplace_back();
+
+            levels[level].push_back(std::move(run));
+            if (levels[level].size() < fan_in)
+                return;
+
+            run = merge_into_run(levels[level]);
+            levels[level].clear();
+        }
+    };
+
+    {
+        std::vector<T> values(run_length);
+        std::vector<std::uint64_t> positions(run_length);
+        std::uint64_t offset = 0;
+        INDEXSORT_COUNT_SCRATCH(run_length *
+                                (sizeof(T) + sizeof(std::uint64_t)));
+
+        std::size_t count;
+        while ((count = source(values.data(), run_length)) != 0)
+        {
+            stable_vector_pair_sort(values.begin(), values.begin() + count,
+                                    positions.begin(),
+                                    positions.begin() + count, cmp);
+
+            file_handle run = temporary_file();
+            {
+                INDEXSORT_PHASE("spill");
+
+                std::FILE * run_file = run.get();
+                auto write = [run_file](const record * data,
+                                        std::size_t length)
+                { write_records(run_file, data, length); };
+
+                buffered_writer<record, decltype(write)> writer(
+                  block_length(8), write);
+                for (std::size_t i = 0; i < count; ++i)
+                    writer.push(record{values[i], offset + positions[i]});
+                writer.flush();
+            }
+
+            add_run(std::move(run));
+            offset += count;
+        }
+    }
+
+    // Equal values are ordered by position, so the runs may be merged in any
+    // order.
+    std::vector<file_handle> runs;
+    for (auto & level : levels)
+        for (auto & run : level)
+            runs.push_back(std::move(run));
+
+    std::vector<std::FILE *> group;
+    for (const auto & run : runs)
+        group.push_back(run.get());
+
+    auto write_values = [value_output](const T * data, std::size_t length)
+    { write_records(value_output, data, length); };
+    auto write_index = [index_output](const std::uint64_t * data,
+                                      std::size_t length)
+    { write_records(index_output, data, length); };
+
+    std::size_t length = block_length(group.size() + 2);
+    buffered_writer<T, decltype(write_values)> value_writer(length,
+                                                            write_values);
+    buffered_writer<std::uint64_t, decltype(write_index)> index_writer(
+      length, write_index);
+
+    merge_runs<T>(group, length, cmp,
+                  [&value_writer, &index_writer](const record & r)
+                  {
+                      value_writer.push(r.value);
+                      index_writer.push(r.position);
+                  });
+    value_writer.flush();
+    index_writer.flush();
+
+    if (std::fflush(value_output) != 0 || std::fflush(index_output) != 0)
+        throw io_error("Writing to file failed!");
+}
+};  // namespace detail
+
+/**
+ * Sort values which don't fit into memory. Values are read from `value_begin`
+ * to `value_end` in runs which fit into `memory_budget` bytes. Every run is
+ * sorted by @ref stable_vector_pair_sort and spilled to a temporary file as
+ * (value, position) pairs. Runs are merged k at a time into longer runs as
+ * they are produced, like in a log-structured merge tree, and the remaining
+ * runs are merged into the output at the end.
+ *
+ * Sorted values are written to the file `value_output_path` and the
+ * permutation index is written to `index_output_path` as `std::uint64_t`.
+ * Both files are raw arrays in native byte order. Equal values keep their
+ * original relative order.
+ *
+ * `InputIt` is only read once, sequentially, so it may be a pointer into a
+ * memory mapped file. Values must be trivially copyable, because they are
+ * written to files as they are in memory. Temporary files are created with
+ * `std::tmpfile()`.
+ *
+ * The budget covers the run buffers and the merge buffers and it is kept
+ * approximately. Buffers never shrink below one record, so a budget smaller
+ * than a few records is exceeded.
+ *
+ * @throws indexsort::io_error If a file can't be opened, read or written.
+ */
+template <typename InputIt, typename Compare>
+void external_sort(InputIt value_begin,
+                   InputIt value_end,
+                   const std::string & value_output_path,
+                   const std::string & index_output_path,
+                   Compare cmp,
+                   std::size_t memory_budget)
+{
+    using value_val_type = typename std::iterator_traits<InputIt>::value_type;
+
+    static_assert(std::is_trivially_copyable_v<value_val_type>,
+                  "external_sort() requires trivially copyable values.");
+
+    auto source = [&value_begin, &value_end](value_val_type * buffer,
+                                             std::size_t length)
+    {
+        std::size_t count = 0;
+        for (; count < length && value_begin != value_end;
+             ++count, ++value_begin)
+            buffer[count] = *value_begin;
+        return count;
+    };
+
+    detail::file_handle value_output =
+      detail::open_file(value_output_path, "wb");
+    detail::file_handle index_output =
+      detail::open_file(index_output_path, "wb");
+
+    detail::external_sort_impl<value_val_type>(
+      source, value_output.get(), index_output.get(), cmp, memory_budget);
+}
+
+/**
+ * @brief @ref external_sort which reads values of type `T` from the file
+ * `value_input_path`.
+ *
+ * The input file is a raw array of `T` in native byte order, the same format
+ * as the sorted output.
+ *
+ * @throws indexsort::io_error If a file can't be opened, read or written, or
+ * if the size of the input file isn't a multiple of `sizeof(T)`.
+ */
+template <typename T, typename Compare>
+void external_sort(const std::string & value_input_path,
+                   const std::string & value_output_path,
+                   const std::string & index_output_path,
+                   Compare cmp,
+                   std::size_t memory_budget)
+{
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "external_sort() requires trivially copyable values.");
+
+    detail::file_handle value_input = detail::open_file(value_input_path, "rb");
+    std::FILE * input = value_input.get();
+
+    auto source = [input](T * buffer, std::size_t length)
+    { return detail::read_records(input, buffer, length); };
+
+    detail::file_handle value_output =
+      detail::open_file(value_output_path, "wb");
+    detail::file_handle index_output =
+      detail::open_file(index_output_path, "wb");
+
+    detail::external_sort_impl<T>(source, value_output.get(),
+                                  index_output.get(), cmp, memory_budget);
+}
+};  // namespace indexsort
+
+#endif
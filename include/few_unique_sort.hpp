@@ -0,0 +1,386 @@
+#ifndef FEW_UNIQUE_SORT_
+#define FEW_UNIQUE_SORT_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Bounds of the number of values sampled to estimate the number of
+ * distinct values. Between them, one in 64 values is sampled.
+ */
+constexpr std::ptrdiff_t min_cardinality_sample = 1024;
+constexpr std::ptrdiff_t max_cardinality_sample = 65536;
+
+/**
+ * @brief Counting sort is used for at most this many distinct values.
+ */
+constexpr std::size_t counting_sort_max_keys = 1024;
+
+/**
+ * @brief Ranges of at most this many values are sorted by `std::sort` in the
+ * three-way quicksort.
+ */
+constexpr std::ptrdiff_t three_way_small_range = 16;
+
+/**
+ * @brief Strategy chosen from a sample of the values.
+ */
+enum class cardinality
+{
+    /** Every sampled value was seen many times. */
+    few,
+    /** Many sampled values were seen more than once. */
+    duplicates,
+    /** Sampled values were mostly distinct. */
+    many
+};
+
+/**
+ * @brief Estimate the cardinality of `[first, first + length)` from evenly
+ * spaced samples.
+ *
+ * Large inputs are sampled more, so that counting sort can be used for up to
+ * @ref counting_sort_max_keys distinct values.
+ *
+ * @return The strategy and the positions of the distinct sampled values in
+ * ascending order.
+ */
+template <typename RandomIt, typename Diff, typename Compare>
+std::pair<cardinality, std::vector<Diff>> sample_cardinality(RandomIt first,
+                                                             Diff length,
+                                                             Compare & cmp)
+{
+    Diff sample_length = std::clamp<Diff>(
+      length / 64, min_cardinality_sample, max_cardinality_sample);
+    sample_length = std::min(sample_length, length);
+
+    std::vector<Diff> sample(sample_length);
+    for (Diff i = 0; i < sample_length; ++i)
+        sample[i] = i * length / sample_length;
+
+    auto before = [first, &cmp](Diff a, Diff b)
+    { return cmp(first[a], first[b]); };
+    std::sort(sample.begin(), sample.end(), before);
+
+    std::vector<Diff> distinct;
+    for (Diff position : sample)
+        if (distinct.empty() || before(distinct.back(), position))
+            distinct.push_back(position);
+
+    // Every distinct value was sampled 8 times on average, so values missing
+    // from the sample are probably rare.
+    if (distinct.size() <= counting_sort_max_keys &&
+        distinct.size() * 8 <= static_cast<std::size_t>(sample_length))
+        return {cardinality::few, std::move(distinct)};
+    if (distinct.size() * 2 <= static_cast<std::size_t>(sample_length))
+        return {cardinality::duplicates, {}};
+    return {cardinality::many, {}};
+}
+
+/**
+ * @brief Bucket of every value: the position of the equal key in the sorted
+ * `keys`.
+ *
+ * Keys are searched by a binary search with a fixed number of steps. The step
+ * is multiplied by the result of the comparison instead of branching on it,
+ * compilers turn a conditional expression into a branch here. Values are
+ * random, so branches would be mispredicted half of the time.
+ *
+ * @return The buckets, or nothing if a value isn't among the keys.
+ */
+template <typename RandomIt, typename Key, typename Compare>
+std::optional<std::vector<std::uint32_t>> find_buckets(
+  RandomIt first,
+  RandomIt last,
+  const std::vector<Key> & keys,
+  Compare & cmp)
+{
+    std::vector<std::uint32_t> buckets;
+    buckets.reserve(std::distance(first, last));
+
+    for (RandomIt i = first; i != last; ++i)
+    {
+        const Key * key = keys.data();
+        std::size_t remaining = keys.size();
+        while (remaining > 1)
+        {
+            std::size_t half = remaining / 2;
+            key += half * static_cast<std::size_t>(cmp(key[half - 1], *i));
+            remaining -= half;
+        }
+
+        if (cmp(*key, *i) || cmp(*i, *key))
+            return std::nullopt;
+        buckets.push_back(static_cast<std::uint32_t>(key - keys.data()));
+    }
+
+    return buckets;
+}
+
+/**
+ * @brief Partition pairs in `[first, last)` three ways by their values around
+ * the median of the first, middle and last value.
+ *
+ * @return `{lt, gt}` such that values in `[first, lt)` are less than the
+ * pivot, values in `[lt, gt)` are equal to it and values in `[gt, last)` are
+ * greater.
+ */
+template <typename RandomIt, typename Compare>
+std::pair<RandomIt, RandomIt> three_way_partition(RandomIt first,
+                                                  RandomIt last,
+                                                  Compare & cmp)
+{
+    RandomIt middle = first + (last - first) / 2;
+    RandomIt pivot_it = middle;
+    if (cmp(middle->first, first->first) != cmp(last[-1].first, first->first))
+        pivot_it = first;
+    else if (cmp(middle->first, last[-1].first) !=
+             cmp(first->first, last[-1].first))
+        pivot_it = last - 1;
+
+    std::iter_swap(first, pivot_it);
+
+    // [first, lt) are less than the pivot, [lt, i) are equal and [gt, last)
+    // are greater. The pivot itself is moved around, but lt always points to
+    // a value equal to it.
+    RandomIt lt = first;
+    RandomIt i = first + 1;
+    RandomIt gt = last;
+    while (i < gt)
+    {
+        if (cmp(i->first, lt->first))
+            std::iter_swap(lt++, i++);
+        else if (cmp(lt->first, i->first))
+            std::iter_swap(i, --gt);
+        else
+            ++i;
+    }
+
+    return {lt, gt};
+}
+
+/**
+ * @brief Three-way quicksort of `[first, last)` by the values of the pairs.
+ *
+ * Every partition step moves all values equal to the pivot to the middle,
+ * where they are final, so `k` distinct values are sorted in `O(n log k)`
+ * time. Like introsort, a range that partitions badly too often is sorted by
+ * `std::sort` instead.
+ */
+template <typename RandomIt, typename Compare>
+void three_way_quicksort(RandomIt first,
+                         RandomIt last,
+                         int budget,
+                         Compare & cmp)
+{
+    using pair_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    while (last - first > three_way_small_range && budget-- > 0)
+    {
+        auto [lt, gt] = three_way_partition(first, last, cmp);
+
+        if (lt - first < last - gt)
+        {
+            three_way_quicksort(first, lt, budget, cmp);
+            first = gt;
+        }
+        else
+        {
+            three_way_quicksort(gt, last, budget, cmp);
+            last = lt;
+        }
+    }
+
+    std::sort(first, last, [&cmp](const pair_type & a, const pair_type & b)
+              { return cmp(a.first, b.first); });
+}
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void few_unique_sort_impl(RandomIt1 value_begin,
+                          RandomIt1 value_end,
+                          RandomIt2 index_begin,
+                          RandomIt2 index_end,
+                          Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    if (length == 0)
+        return;
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using value_diff_type = decltype(length);
+    using pair_type = std::pair<value_val_type, index_val_type>;
+
+    auto [kind, distinct] = sample_cardinality(value_begin, length, cmp);
+
+    if constexpr (std::is_copy_constructible_v<value_val_type> &&
+                  std::is_default_constructible_v<value_val_type>)
+    {
+        if (kind == cardinality::few)
+        {
+            std::vector<value_val_type> sorted;
+
+            {
+                INDEXSORT_PHASE("sort");
+
+                std::vector<value_val_type> keys;
+                keys.reserve(distinct.size());
+                for (value_diff_type position : distinct)
+                    keys.push_back(value_begin[position]);
+
+                auto buckets = find_buckets(value_begin, value_end, keys, cmp);
+                if (buckets)
+                {
+                    INDEXSORT_COUNT_SCRATCH(length * (sizeof(std::uint32_t) +
+                                                      sizeof(value_val_type)));
+
+                    // Stable counting sort: every bucket starts after all
+                    // smaller buckets.
+                    std::vector<value_diff_type> offsets(keys.size() + 1);
+                    for (std::uint32_t bucket : *buckets)
+                        ++offsets[bucket + 1];
+                    std::partial_sum(offsets.begin(), offsets.end(),
+                                     offsets.begin());
+
+                    // Values are moved to the slot of their bucket in a
+                    // buffer, positions are written directly to the index.
+                    sorted.resize(length);
+                    for (value_diff_type i = 0; i < length; ++i)
+                    {
+                        value_diff_type slot = offsets[(*buckets)[i]]++;
+                        sorted[slot] = std::move(value_begin[i]);
+                        index_begin[slot] = static_cast<index_val_type>(i);
+                    }
+                }
+            }
+
+            // The input isn't empty, so values were counting sorted if the
+            // buffer isn't empty either.
+            if (!sorted.empty())
+            {
+                INDEXSORT_PHASE("apply");
+                std::move(sorted.begin(), sorted.end(), value_begin);
+                return;
+            }
+
+            // A value which wasn't sampled, the keys aren't complete. There
+            // are still many duplicates.
+            kind = cardinality::duplicates;
+        }
+    }
+
+    std::vector<pair_type> conversion;
+    conversion.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(pair_type));
+
+    {
+        INDEXSORT_PHASE("sort");
+
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+            conversion.emplace_back(std::move(*i), n++);
+
+        // Sorting positions in every range of equal values after three-way
+        // partitioning is slower than std::stable_sort.
+        if (kind == cardinality::many || Stable)
+        {
+            detail::sort<Stable>(
+              conversion.begin(), conversion.end(),
+              [&cmp](const pair_type & a, const pair_type & b)
+              { return cmp(a.first, b.first); });
+        }
+        else
+        {
+            int budget = 0;
+            for (auto remaining = length; remaining > 1; remaining /= 2)
+                budget += 2;
+            three_way_quicksort(conversion.begin(), conversion.end(), budget,
+                                cmp);
+        }
+    }
+
+    INDEXSORT_PHASE("apply");
+    for (value_diff_type i = 0; i < length; ++i)
+    {
+        value_begin[i] = std::move(conversion[i].first);
+        index_begin[i] = conversion[i].second;
+    }
+}
+};  // namespace detail
+
+/**
+ * Index sort for values with few distinct values, like status codes or
+ * categories.
+ *
+ * A sample of evenly spaced values (one in 64, at least 1024 and at most
+ * 65536) is sorted to estimate the number of distinct values:
+ * - If every sampled value was seen about 8 times or more and there are at
+ *   most 1024 of them, values are counting sorted. Every value is
+ *   looked up among the distinct sampled values by binary search and moved
+ *   to its bucket, which takes `O(n log k)` comparisons for `k` distinct
+ *   values. If a value wasn't sampled, the algorithm continues with the next
+ *   case.
+ * - If many sampled values were duplicates, values are sorted as pairs of the
+ *   value and its index by three-way quicksort, which moves all values equal
+ *   to the pivot into their final place in one step.
+ * - Otherwise values are sorted as pairs like in @ref vector_pair_sort.
+ *
+ * The counting sort requires copy constructible and default constructible
+ * values, other values skip it.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void few_unique_sort(RandomIt1 value_begin,
+                     RandomIt1 value_end,
+                     RandomIt2 index_begin,
+                     RandomIt2 index_end,
+                     Compare cmp)
+{
+    detail::few_unique_sort_impl<false>(value_begin, value_end, index_begin,
+                                        index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref few_unique_sort.
+ *
+ * Counting sort is stable by itself. Values which aren't counting sorted are
+ * sorted by `std::stable_sort` instead of three-way quicksort, which isn't
+ * stable. Equal values therefore keep their original relative order in the
+ * permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_few_unique_sort(RandomIt1 value_begin,
+                            RandomIt1 value_end,
+                            RandomIt2 index_begin,
+                            RandomIt2 index_end,
+                            Compare cmp)
+{
+    detail::few_unique_sort_impl<true>(value_begin, value_end, index_begin,
+                                       index_end, cmp);
+}
+};  // namespace indexsort
+
+#endif
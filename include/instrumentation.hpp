@@ -0,0 +1,480 @@
+#ifndef INSTRUMENTATION_
+#define INSTRUMENTATION_
+
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+#if defined(INDEXSORT_INSTRUMENTATION) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file
+ * Opt-in instrumentation of the algorithms.
+ *
+ * Algorithms mark their phases with @ref INDEXSORT_PHASE and their temporary
+ * buffers with @ref INDEXSORT_COUNT_SCRATCH. Both expand to nothing unless
+ * `INDEXSORT_INSTRUMENTATION` is defined before including any header of this
+ * library, so instrumentation costs nothing by default.
+ *
+ * Comparisons, value moves and index dereferences happen inside the standard
+ * library, so they are counted by wrapping the arguments of an algorithm
+ * instead: @ref instrumentation::counted_compare, @ref
+ * instrumentation::counted values and @ref instrumentation::counted_iterator.
+ * The wrappers work with and without `INDEXSORT_INSTRUMENTATION`.
+ *
+ * All counts are collected per thread in @ref instrumentation::current().
+ */
+
+#ifdef INDEXSORT_INSTRUMENTATION
+/**
+ * @brief Measure the rest of the enclosing scope as phase `name`.
+ */
+#define INDEXSORT_PHASE(name)                                                  \
+    ::indexsort::instrumentation::phase_timer indexsort_phase_timer_(name)
+
+/**
+ * @brief Count `bytes` of temporary memory allocated by an algorithm.
+ */
+#define INDEXSORT_COUNT_SCRATCH(bytes)                                         \
+    (::indexsort::instrumentation::current().scratch_bytes +=                  \
+     static_cast<std::uint64_t>(bytes))
+#else
+#define INDEXSORT_PHASE(name) static_cast<void>(0)
+#define INDEXSORT_COUNT_SCRATCH(bytes) static_cast<void>(0)
+#endif
+
+namespace indexsort
+{
+namespace instrumentation
+{
+/**
+ * @brief Time and hardware events spent in one phase of the algorithms.
+ *
+ * Hardware counters are empty if `perf_event_open` isn't available, for
+ * example outside of Linux, in containers without permission or when
+ * `/proc/sys/kernel/perf_event_paranoid` forbids it.
+ */
+struct phase_statistics
+{
+    std::uint64_t calls = 0;
+    std::chrono::nanoseconds time{0};
+    std::optional<std::uint64_t> cache_misses;
+    std::optional<std::uint64_t> branch_misses;
+};
+
+/**
+ * @brief Counts collected by the instrumentation.
+ */
+struct statistics
+{
+    /** Calls of a @ref counted_compare. */
+    std::uint64_t comparisons = 0;
+    /** Move constructions and assignments of @ref counted values. */
+    std::uint64_t moves = 0;
+    /** Copy constructions and assignments of @ref counted values. */
+    std::uint64_t copies = 0;
+    /** Swaps of @ref counted values. */
+    std::uint64_t swaps = 0;
+    /** Dereferences of a @ref counted_iterator. */
+    std::uint64_t index_dereferences = 0;
+    /** Bytes of temporary buffers allocated by the algorithms. */
+    std::uint64_t scratch_bytes = 0;
+    /** Phases of the algorithms by their name, like "sort" and "apply". */
+    std::map<std::string, phase_statistics> phases;
+};
+
+/**
+ * @brief Statistics of the calling thread.
+ */
+inline statistics & current()
+{
+    thread_local statistics stats;
+    return stats;
+}
+
+/**
+ * @brief Reset the statistics of the calling thread.
+ */
+inline void reset()
+{
+    current() = statistics();
+}
+
+#ifdef INDEXSORT_INSTRUMENTATION
+/**
+ * @brief Cache miss and branch miss counters of the calling thread, read
+ * through `perf_event_open`.
+ */
+class hardware_counters
+{
+public:
+    struct values
+    {
+        std::uint64_t cache_misses;
+        std::uint64_t branch_misses;
+    };
+
+    /**
+     * @brief Counters of the calling thread, opened on first use.
+     */
+    static hardware_counters & thread_counters()
+    {
+        thread_local hardware_counters counters;
+        return counters;
+    }
+
+    hardware_counters(const hardware_counters &) = delete;
+    hardware_counters & operator=(const hardware_counters &) = delete;
+
+    ~hardware_counters()
+    {
+#if defined(__linux__)
+        if (branch_fd_ != -1)
+            ::close(branch_fd_);
+        if (cache_fd_ != -1)
+            ::close(cache_fd_);
+#endif
+    }
+
+    /**
+     * @brief Current values, or nothing if the counters aren't available.
+     */
+    std::optional<values> read() const
+    {
+#if defined(__linux__)
+        std::uint64_t cache_misses;
+        std::uint64_t branch_misses;
+        if (cache_fd_ != -1 && branch_fd_ != -1 &&
+            ::read(cache_fd_, &cache_misses, sizeof(cache_misses)) ==
+              sizeof(cache_misses) &&
+            ::read(branch_fd_, &branch_misses, sizeof(branch_misses)) ==
+              sizeof(branch_misses))
+            return values{cache_misses, branch_misses};
+#endif
+        return std::nullopt;
+    }
+
+private:
+    hardware_counters()
+    {
+#if defined(__linux__)
+        cache_fd_ = open(PERF_COUNT_HW_CACHE_MISSES);
+        branch_fd_ = open(PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+
+#if defined(__linux__)
+    static int open(std::uint64_t event)
+    {
+        perf_event_attr attributes{};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = event;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        // Count the calling thread on any CPU.
+        long fd = ::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        return static_cast<int>(fd);
+    }
+#endif
+
+    int cache_fd_ = -1;
+    int branch_fd_ = -1;
+};
+
+/**
+ * @brief Adds the time and hardware events between its construction and
+ * destruction to a phase of @ref current().
+ */
+class phase_timer
+{
+public:
+    explicit phase_timer(const char * name)
+      : name_(name),
+        counters_(hardware_counters::thread_counters().read()),
+        start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    phase_timer(const phase_timer &) = delete;
+    phase_timer & operator=(const phase_timer &) = delete;
+
+    ~phase_timer()
+    {
+        auto end = std::chrono::steady_clock::now();
+        auto counters = hardware_counters::thread_counters().read();
+
+        phase_statistics & phase = current().phases[name_];
+        ++phase.calls;
+        phase.time += end - start_;
+
+        if (counters_ && counters)
+        {
+            phase.cache_misses = phase.cache_misses.value_or(0) +
+                                 counters->cache_misses -
+                                 counters_->cache_misses;
+            phase.branch_misses = phase.branch_misses.value_or(0) +
+                                  counters->branch_misses -
+                                  counters_->branch_misses;
+        }
+    }
+
+private:
+    const char * name_;
+    std::optional<hardware_counters::values> counters_;
+    std::chrono::steady_clock::time_point start_;
+};
+#endif
+
+template <typename T>
+class counted;
+
+/**
+ * @brief Comparator which counts its calls in @ref statistics::comparisons.
+ *
+ * @ref counted values are unwrapped before they are passed to `Compare`.
+ */
+template <typename Compare>
+class counted_compare
+{
+public:
+    explicit counted_compare(Compare cmp) : cmp_(std::move(cmp))
+    {
+    }
+
+    template <typename A, typename B>
+    bool operator()(const A & a, const B & b) const
+    {
+        ++current().comparisons;
+        return cmp_(unwrap(a), unwrap(b));
+    }
+
+private:
+    template <typename T>
+    static const T & unwrap(const T & value)
+    {
+        return value;
+    }
+
+    template <typename T>
+    static const T & unwrap(const counted<T> & value);
+
+    Compare cmp_;
+};
+
+/**
+ * @brief Value which counts how often it is moved, copied and swapped.
+ */
+template <typename T>
+class counted
+{
+public:
+    using value_type = T;
+
+    counted() = default;
+
+    counted(T value) : value_(std::move(value))
+    {
+    }
+
+    counted(const counted & other) : value_(other.value_)
+    {
+        ++current().copies;
+    }
+
+    counted(counted && other) noexcept : value_(std::move(other.value_))
+    {
+        ++current().moves;
+    }
+
+    counted & operator=(const counted & other)
+    {
+        ++current().copies;
+        value_ = other.value_;
+        return *this;
+    }
+
+    counted & operator=(counted && other) noexcept
+    {
+        ++current().moves;
+        value_ = std::move(other.value_);
+        return *this;
+    }
+
+    friend void swap(counted & a, counted & b) noexcept
+    {
+        ++current().swaps;
+        using std::swap;
+        swap(a.value_, b.value_);
+    }
+
+    const T & value() const noexcept
+    {
+        return value_;
+    }
+
+    bool operator==(const counted & other) const
+    {
+        return value_ == other.value_;
+    }
+
+private:
+    T value_{};
+};
+
+template <typename Compare>
+template <typename T>
+const T & counted_compare<Compare>::unwrap(const counted<T> & value)
+{
+    return value.value();
+}
+
+/**
+ * @brief Random access iterator which counts dereferences in
+ * @ref statistics::index_dereferences.
+ *
+ * Wrap index iterators in it to count how often an algorithm reads or writes
+ * the index.
+ */
+template <typename RandomIt>
+class counted_iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    using difference_type =
+      typename std::iterator_traits<RandomIt>::difference_type;
+    using pointer = typename std::iterator_traits<RandomIt>::pointer;
+    using reference = typename std::iterator_traits<RandomIt>::reference;
+
+    counted_iterator() = default;
+
+    explicit counted_iterator(RandomIt it) : it_(it)
+    {
+    }
+
+    reference operator*() const
+    {
+        ++current().index_dereferences;
+        return *it_;
+    }
+
+    reference operator[](difference_type n) const
+    {
+        ++current().index_dereferences;
+        return it_[n];
+    }
+
+    pointer operator->() const
+    {
+        ++current().index_dereferences;
+        return &*it_;
+    }
+
+    counted_iterator & operator++()
+    {
+        ++it_;
+        return *this;
+    }
+
+    counted_iterator operator++(int)
+    {
+        return counted_iterator(it_++);
+    }
+
+    counted_iterator & operator--()
+    {
+        --it_;
+        return *this;
+    }
+
+    counted_iterator operator--(int)
+    {
+        return counted_iterator(it_--);
+    }
+
+    counted_iterator & operator+=(difference_type n)
+    {
+        it_ += n;
+        return *this;
+    }
+
+    counted_iterator & operator-=(difference_type n)
+    {
+        it_ -= n;
+        return *this;
+    }
+
+    friend counted_iterator operator+(counted_iterator it, difference_type n)
+    {
+        return it += n;
+    }
+
+    friend counted_iterator operator+(difference_type n, counted_iterator it)
+    {
+        return it += n;
+    }
+
+    friend counted_iterator operator-(counted_iterator it, difference_type n)
+    {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const counted_iterator & a,
+                                     const counted_iterator & b)
+    {
+        return a.it_ - b.it_;
+    }
+
+    friend bool operator==(const counted_iterator & a,
+                           const counted_iterator & b)
+    {
+        return a.it_ == b.it_;
+    }
+
+    friend bool operator!=(const counted_iterator & a,
+                           const counted_iterator & b)
+    {
+        return a.it_ != b.it_;
+    }
+
+    friend bool operator<(const counted_iterator & a,
+                          const counted_iterator & b)
+    {
+        return a.it_ < b.it_;
+    }
+
+    friend bool operator>(const counted_iterator & a,
+                          const counted_iterator & b)
+    {
+        return a.it_ > b.it_;
+    }
+
+    friend bool operator<=(const counted_iterator & a,
+                           const counted_iterator & b)
+    {
+        return a.it_ <= b.it_;
+    }
+
+    friend bool operator>=(const counted_iterator & a,
+                           const counted_iterator & b)
+    {
+        return a.it_ >= b.it_;
+    }
+
+private:
+    RandomIt it_{};
+};
+};  // namespace instrumentation
+};  // namespace indexsort
+
+#endif
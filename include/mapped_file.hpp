@@ -0,0 +1,300 @@
+#ifndef MAPPED_FILE_
+#define MAPPED_FILE_
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+#include "base.hpp"
+#include "boost_index_apply_sort.hpp"
+
+namespace indexsort
+{
+/**
+ * @brief Expected access pattern of a @ref mapped_array, passed to `madvise`.
+ */
+enum class access_pattern
+{
+    normal,
+    sequential,
+    random,
+    will_need,
+    dont_need
+};
+
+/**
+ * @brief Binary file of `T`s in native byte order mapped into memory.
+ *
+ * The file is mapped with `mmap`, so its contents are read on demand and
+ * written back by the kernel, without being copied into a buffer. `begin()`
+ * and `end()` are pointers, so they can be passed to every algorithm as
+ * `RandomIt1` or `RandomIt2`.
+ *
+ * If `T` is `const`, the file is mapped read only. Otherwise it is mapped read
+ * write and changes are written to the file.
+ *
+ * This class requires POSIX.
+ */
+template <typename T>
+class mapped_array
+{
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "mapped_array requires trivially copyable elements.");
+
+public:
+    using value_type = std::remove_const_t<T>;
+    using iterator = T *;
+
+    /**
+     * @brief Map the existing file `path`.
+     *
+     * @throws indexsort::io_error If the file can't be opened or mapped.
+     */
+    explicit mapped_array(const std::string & path)
+    {
+        open(path, std::is_const_v<T> ? O_RDONLY : O_RDWR);
+
+        struct stat status;
+        if (::fstat(fd_, &status) != 0)
+            fail("Can't get size of file " + path);
+
+        map(static_cast<std::size_t>(status.st_size) / sizeof(T));
+    }
+
+    /**
+     * @brief Create the file `path` with room for `length` elements, or
+     * truncate it if it exists, and map it.
+     *
+     * @throws indexsort::io_error If the file can't be created or mapped.
+     */
+    mapped_array(const std::string & path, std::size_t length)
+    {
+        static_assert(!std::is_const_v<T>,
+                      "A file created for writing can't be mapped read only.");
+
+        open(path, O_RDWR | O_CREAT | O_TRUNC);
+
+        if (::ftruncate(fd_, static_cast<off_t>(length * sizeof(T))) != 0)
+            fail("Can't resize file " + path);
+
+        map(length);
+    }
+
+    mapped_array(mapped_array && other) noexcept
+      : fd_(std::exchange(other.fd_, -1)),
+        data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    mapped_array & operator=(mapped_array && other) noexcept
+    {
+        std::swap(fd_, other.fd_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    mapped_array(const mapped_array &) = delete;
+    mapped_array & operator=(const mapped_array &) = delete;
+
+    ~mapped_array()
+    {
+        if (data_ != nullptr)
+            ::munmap(const_cast<value_type *>(data_), size_ * sizeof(T));
+        if (fd_ != -1)
+            ::close(fd_);
+    }
+
+    T * begin() const noexcept
+    {
+        return data_;
+    }
+
+    T * end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    T * data() const noexcept
+    {
+        return data_;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    T & operator[](std::size_t i) const noexcept
+    {
+        return data_[i];
+    }
+
+    /**
+     * @brief Tell the kernel how the elements will be accessed next, so that
+     * it can read ahead or drop pages accordingly.
+     *
+     * The hint doesn't change the contents. Failures are ignored, the hint is
+     * only an optimization.
+     */
+    void advise(access_pattern pattern) const noexcept
+    {
+        if (data_ == nullptr)
+            return;
+
+        int advice = MADV_NORMAL;
+        switch (pattern)
+        {
+        case access_pattern::normal:
+            advice = MADV_NORMAL;
+            break;
+        case access_pattern::sequential:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case access_pattern::random:
+            advice = MADV_RANDOM;
+            break;
+        case access_pattern::will_need:
+            advice = MADV_WILLNEED;
+            break;
+        case access_pattern::dont_need:
+            advice = MADV_DONTNEED;
+            break;
+        }
+
+        ::madvise(const_cast<value_type *>(data_), size_ * sizeof(T), advice);
+    }
+
+    /**
+     * @brief Write changed elements to the file and wait until they are
+     * written.
+     *
+     * @throws indexsort::io_error If writing fails.
+     */
+    void sync() const
+    {
+        if (data_ != nullptr &&
+            ::msync(const_cast<value_type *>(data_), size_ * sizeof(T),
+                    MS_SYNC) != 0)
+            throw io_error(std::string("Can't write mapped file: ") +
+                           std::strerror(errno) + "!");
+    }
+
+private:
+    /**
+     * Close the file and throw. Only called from constructors, whose failure
+     * means that the destructor won't run.
+     */
+    [[noreturn]] void fail(const std::string & message)
+    {
+        int error = errno;
+        if (fd_ != -1)
+            ::close(fd_);
+
+        throw io_error(message + ": " + std::strerror(error) + "!");
+    }
+
+    void open(const std::string & path, int flags)
+    {
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ == -1)
+            fail("Can't open file " + path);
+    }
+
+    void map(std::size_t length)
+    {
+        size_ = length;
+        if (length == 0)
+            return;
+
+        int protection = std::is_const_v<T> ? PROT_READ
+                                            : PROT_READ | PROT_WRITE;
+        void * memory = ::mmap(nullptr, length * sizeof(T), protection,
+                               MAP_SHARED, fd_, 0);
+        if (memory == MAP_FAILED)
+            fail("Can't map file");
+
+        data_ = static_cast<T *>(memory);
+    }
+
+    int fd_ = -1;
+    T * data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+namespace detail
+{
+/**
+ * @brief Advise a @ref mapped_array for an access pattern while the guard
+ * lives and back to `access_pattern::normal` when it's destroyed, also by an
+ * exception.
+ */
+template <typename T>
+class scoped_advice
+{
+public:
+    scoped_advice(const mapped_array<T> & array,
+                  access_pattern pattern) noexcept
+      : array_(array)
+    {
+        array_.advise(pattern);
+    }
+
+    scoped_advice(const scoped_advice &) = delete;
+    scoped_advice & operator=(const scoped_advice &) = delete;
+
+    ~scoped_advice()
+    {
+        array_.advise(access_pattern::normal);
+    }
+
+private:
+    const mapped_array<T> & array_;
+};
+};  // namespace detail
+
+/**
+ * @brief @ref boost_index_apply_sort of memory mapped files which tells the
+ * kernel how each phase accesses the files.
+ *
+ * Sorting the index reads values at random, while the index itself is
+ * scanned by the partitions of `std::sort`. Applying the permutation reads a
+ * copy of the index in order and moves values along its cycles, again at
+ * random. Values are advised for random access, so that the kernel doesn't
+ * waste I/O reading ahead pages that won't be touched, and the index for
+ * sequential access, so that it is read ahead. Both are advised back to normal
+ * at the end, even if `cmp` throws.
+ *
+ * The copy of the index is held in memory, just like in
+ * @ref boost_index_apply_sort.
+ *
+ * @throws indexsort::length_mismatch_error If `values.size() !=
+ * index.size()`.
+ */
+template <typename T, typename Index, typename Compare>
+void mapped_boost_index_apply_sort(const mapped_array<T> & values,
+                                   const mapped_array<Index> & index,
+                                   Compare cmp)
+{
+    if (values.size() != index.size())
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    detail::scoped_advice<T> values_advice(values, access_pattern::random);
+    detail::scoped_advice<Index> index_advice(index,
+                                              access_pattern::sequential);
+
+    boost_index_apply_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef MULTI_KEY_SORT_
+#define MULTI_KEY_SORT_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "apply_permutation.hpp"
+#include "argsort.hpp"
+#include "base.hpp"
+#include "instrumentation.hpp"
+
+namespace indexsort
+{
+/**
+ * @brief Direction in which a column is sorted.
+ */
+enum class sort_direction
+{
+    ascending,
+    descending
+};
+
+/**
+ * @brief Column of values to sort by, created by @ref column.
+ */
+template <typename RandomIt>
+struct sort_column
+{
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    RandomIt begin;
+    RandomIt end;
+    sort_direction direction;
+
+    /**
+     * @brief Whether value `a` goes before value `b` in this column.
+     */
+    bool ordered(const value_type & a, const value_type & b) const
+    {
+        if (direction == sort_direction::ascending)
+            return a < b;
+        return b < a;
+    }
+
+    /**
+     * @brief Whether the value at position `a` goes before the value at
+     * position `b` in this column.
+     */
+    template <typename Index>
+    bool before(const Index & a, const Index & b) const
+    {
+        return ordered(begin[a], begin[b]);
+    }
+};
+
+/**
+ * @brief Column of values from `begin` to `end` sorted in `direction`.
+ *
+ * Values are compared with `operator<`. Columns may have different value
+ * types.
+ */
+template <typename RandomIt>
+sort_column<RandomIt> column(
+  RandomIt begin,
+  RandomIt end,
+  sort_direction direction = sort_direction::ascending)
+{
+    return {begin, end, direction};
+}
+
+namespace detail
+{
+/**
+ * Tied ranges of arithmetic values at least this long are sorted as
+ * (value, position) pairs gathered into a buffer, so that the sort reads
+ * contiguous memory instead of values scattered over the whole column.
+ */
+constexpr std::ptrdiff_t gather_min_length = 64;
+
+/**
+ * @brief Sort `[first, last)` of the index by the values of `column`, ties
+ * broken by position.
+ */
+template <typename RandomIt2, typename Column>
+void sort_by_column(RandomIt2 first, RandomIt2 last, const Column & column)
+{
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using value_val_type = typename Column::value_type;
+
+    if constexpr (std::is_arithmetic_v<value_val_type>)
+    {
+        if (last - first >= gather_min_length)
+        {
+            using row_type = std::pair<value_val_type, index_val_type>;
+
+            std::vector<row_type> rows;
+            rows.reserve(static_cast<std::size_t>(last - first));
+            INDEXSORT_COUNT_SCRATCH((last - first) * sizeof(row_type));
+            for (RandomIt2 i = first; i != last; ++i)
+                rows.emplace_back(column.begin[*i], *i);
+
+            std::sort(rows.begin(), rows.end(),
+                      [&column](const auto & a, const auto & b)
+                      {
+                          return column.ordered(a.first, b.first) ||
+                                 (!column.ordered(b.first, a.first) &&
+                                  a.second < b.second);
+                      });
+
+            std::transform(rows.begin(), rows.end(), first,
+                           [](const auto & row) { return row.second; });
+            return;
+        }
+    }
+
+    std::sort(first, last,
+              [&column](const index_val_type & a, const index_val_type & b)
+              {
+                  return column.before(a, b) ||
+                         (!column.before(b, a) && a < b);
+              });
+}
+
+template <typename RandomIt2>
+void refine_ties(RandomIt2, RandomIt2)
+{
+}
+
+/**
+ * @brief Sort `[first, last)` of the index by `column` and then refine every
+ * range of values equal in `column` by the remaining columns.
+ *
+ * All positions in `[first, last)` have equal values in the previous columns
+ * and they are sorted by position. Ties are broken by position again, so the
+ * sort is stable.
+ */
+template <typename RandomIt2, typename Column, typename... Columns>
+void refine_ties(RandomIt2 first,
+                 RandomIt2 last,
+                 const Column & column,
+                 const Columns &... columns)
+{
+    sort_by_column(first, last, column);
+
+    if constexpr (sizeof...(Columns) > 0)
+    {
+        while (first != last)
+        {
+            RandomIt2 tie_end = first + 1;
+            while (tie_end != last && !column.before(*first, *tie_end))
+                ++tie_end;
+
+            if (tie_end - first > 1)
+                refine_ties(first, tie_end, columns...);
+            first = tie_end;
+        }
+    }
+}
+
+template <typename RandomIt2, typename Column>
+void check_column_length(RandomIt2 index_begin,
+                         RandomIt2 index_end,
+                         const Column & column)
+{
+    if (std::distance(column.begin, column.end) !=
+        std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+}
+
+/**
+ * @brief Stable argsort of the first column, which takes the radix sort path
+ * of @ref argsort for ordered keys.
+ */
+template <typename RandomIt2, typename RandomIt>
+void argsort_column(RandomIt2 index_begin,
+                    RandomIt2 index_end,
+                    const sort_column<RandomIt> & column)
+{
+    using value_val_type = typename std::iterator_traits<RandomIt>::value_type;
+
+    if (column.direction == sort_direction::ascending)
+        stable_argsort(column.begin, column.end, index_begin, index_end,
+                       std::less<value_val_type>());
+    else
+        stable_argsort(column.begin, column.end, index_begin, index_end,
+                       std::greater<value_val_type>());
+}
+};  // namespace detail
+
+/**
+ * Compute the permutation index which orders rows of several columns
+ * lexicographically, like `ORDER BY` in SQL. Columns are created by
+ * @ref column and each of them may have a different value type and direction.
+ *
+ * The index is first sorted by the first column with @ref stable_argsort.
+ * Then every range of positions whose values are equal in the first column is
+ * sorted by the second column, ranges equal in both are sorted by the third
+ * column and so on. Later columns are therefore only read for rows which are
+ * tied in all previous columns. Long tied ranges of arithmetic values are
+ * gathered into a buffer before sorting, like a column store would do. Rows
+ * equal in all columns keep their original relative order.
+ *
+ * Values aren't modified or copied.
+ *
+ * @throws indexsort::length_mismatch_error If the length of any column doesn't
+ * match `std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt2, typename Column, typename... Columns>
+void multi_key_argsort(RandomIt2 index_begin,
+                       RandomIt2 index_end,
+                       const Column & first_column,
+                       const Columns &... columns)
+{
+    detail::check_column_length(index_begin, index_end, first_column);
+    (detail::check_column_length(index_begin, index_end, columns), ...);
+
+    detail::argsort_column(index_begin, index_end, first_column);
+
+    if constexpr (sizeof...(Columns) > 0)
+    {
+        INDEXSORT_PHASE("refine");
+
+        RandomIt2 first = index_begin;
+        while (first != index_end)
+        {
+            RandomIt2 tie_end = first + 1;
+            while (tie_end != index_end &&
+                   !first_column.before(*first, *tie_end))
+                ++tie_end;
+
+            if (tie_end - first > 1)
+                detail::refine_ties(first, tie_end, columns...);
+            first = tie_end;
+        }
+    }
+}
+
+/**
+ * @brief @ref multi_key_argsort which also applies the permutation index to
+ * all columns.
+ *
+ * Every column is reordered with @ref apply_permutation, so values are moved,
+ * never copied.
+ *
+ * @throws indexsort::length_mismatch_error If the length of any column doesn't
+ * match `std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt2, typename... Columns>
+void multi_key_sort(RandomIt2 index_begin,
+                    RandomIt2 index_end,
+                    const Columns &... columns)
+{
+    multi_key_argsort(index_begin, index_end, columns...);
+
+    INDEXSORT_PHASE("apply");
+    (apply_permutation(columns.begin, columns.end, index_begin, index_end),
+     ...);
+}
+};  // namespace indexsort
+
+#endif
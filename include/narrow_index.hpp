@@ -0,0 +1,98 @@
+#ifndef NARROW_INDEX_
+#define NARROW_INDEX_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if defined(__GNUC__)
+#define INDEXSORT_PACKED __attribute__((packed))
+#else
+#define INDEXSORT_PACKED
+#endif
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Call `function(Index())` with the narrowest unsigned integer type
+ * `Index` that can hold every position of `length` values.
+ *
+ * `Wide` is the index type of the caller. It is used if it isn't wider than the
+ * narrow candidates, so the internal index is never wider than the output.
+ */
+template <typename Wide, typename Function>
+void with_narrow_index(std::size_t length, Function function)
+{
+    if constexpr (sizeof(Wide) > sizeof(std::uint16_t))
+    {
+        if (length <= std::numeric_limits<std::uint16_t>::max())
+            return function(std::uint16_t());
+    }
+    if constexpr (sizeof(Wide) > sizeof(std::uint32_t))
+    {
+        if (length <= std::numeric_limits<std::uint32_t>::max())
+            return function(std::uint32_t());
+    }
+    function(Wide());
+}
+
+/**
+ * @brief Pair of an arithmetic value and its index without padding.
+ *
+ * `std::pair<double, std::uint32_t>` is padded to 16 bytes, this pair takes 12
+ * bytes. Members may be misaligned, so they must be read and written by value,
+ * never bound to references.
+ */
+template <typename T, typename Index>
+struct INDEXSORT_PACKED packed_pair
+{
+    T first;
+    Index second;
+
+    packed_pair(T value, Index index) : first(value), second(index)
+    {
+    }
+};
+
+/**
+ * @brief Pair of a value and a narrow index, which is a @ref packed_pair if
+ * `std::pair` would be padded and values can be read by value.
+ */
+template <typename T, typename Index>
+using index_pair_t = std::conditional_t<
+  (std::is_arithmetic_v<T> &&
+   sizeof(std::pair<T, Index>) > sizeof(T) + sizeof(Index)),
+  packed_pair<T, Index>,
+  std::pair<T, Index>>;
+
+template <typename T, typename Index>
+const T & pair_value(const std::pair<T, Index> & pair)
+{
+    return pair.first;
+}
+
+template <typename T, typename Index>
+T pair_value(const packed_pair<T, Index> & pair)
+{
+    return pair.first;
+}
+
+template <typename T, typename Index>
+T && take_pair_value(std::pair<T, Index> & pair)
+{
+    return std::move(pair.first);
+}
+
+template <typename T, typename Index>
+T take_pair_value(packed_pair<T, Index> & pair)
+{
+    return pair.first;
+}
+};  // namespace detail
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef ORDERED_KEY_
+#define ORDERED_KEY_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace indexsort
+{
+namespace detail
+{
+template <std::size_t Size>
+struct unsigned_of_size
+{
+};
+
+template <>
+struct unsigned_of_size<1>
+{
+    using type = std::uint8_t;
+};
+
+template <>
+struct unsigned_of_size<2>
+{
+    using type = std::uint16_t;
+};
+
+template <>
+struct unsigned_of_size<4>
+{
+    using type = std::uint32_t;
+};
+
+template <>
+struct unsigned_of_size<8>
+{
+    using type = std::uint64_t;
+};
+
+/**
+ * @brief Tells whether `Compare` sorts `T` in ascending or descending order.
+ *
+ * Only `std::less` and `std::greater` (including their transparent `void`
+ * specializations) are recognized. Algorithms that work on the bit
+ * representation of values instead of calling the comparator use this to
+ * reject comparators they can't emulate.
+ */
+template <typename Compare, typename T>
+struct compare_direction
+{
+    static constexpr bool supported = false;
+    static constexpr bool descending = false;
+};
+
+template <typename T>
+struct compare_direction<std::less<T>, T>
+{
+    static constexpr bool supported = true;
+    static constexpr bool descending = false;
+};
+
+template <typename T>
+struct compare_direction<std::less<>, T>
+{
+    static constexpr bool supported = true;
+    static constexpr bool descending = false;
+};
+
+template <typename T>
+struct compare_direction<std::greater<T>, T>
+{
+    static constexpr bool supported = true;
+    static constexpr bool descending = true;
+};
+
+template <typename T>
+struct compare_direction<std::greater<>, T>
+{
+    static constexpr bool supported = true;
+    static constexpr bool descending = true;
+};
+
+template <typename T>
+constexpr bool ordered_key_supported_v =
+  (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+  (std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 &&
+   (sizeof(T) == 4 || sizeof(T) == 8));
+
+/**
+ * @brief Maps arithmetic values to unsigned integers whose natural order
+ * matches the order of the values.
+ *
+ * Unsigned integers are left as they are. Signed integers have their sign bit
+ * flipped. IEEE floating point numbers have their sign bit flipped if they are
+ * positive and all of their bits flipped if they are negative. NaNs end up
+ * either before or after all other numbers depending on their sign bit.
+ * `-0.0` has the key of `0.0`, because they are equal for `std::less` and
+ * `std::greater`, so `from_key` returns `0.0` for both (see
+ * @ref negative_zeros).
+ */
+template <typename T>
+struct ordered_key
+{
+    static_assert(ordered_key_supported_v<T>,
+                  "ordered_key supports only integers and IEEE floating "
+                  "point numbers of size 4 or 8.");
+
+    using type = typename unsigned_of_size<sizeof(T)>::type;
+
+    static constexpr type sign_bit = static_cast<type>(
+      type(1) << (std::numeric_limits<type>::digits - 1));
+
+    static type to_key(T value) noexcept
+    {
+        type bits;
+        std::memcpy(&bits, &value, sizeof(T));
+
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if (bits == sign_bit)
+                bits = 0;
+
+            type negative = static_cast<type>(
+              bits >> (std::numeric_limits<type>::digits - 1));
+            bits ^= static_cast<type>(static_cast<type>(-negative) | sign_bit);
+        }
+        else if constexpr (std::is_signed_v<T>)
+            bits ^= sign_bit;
+
+        return bits;
+    }
+
+    static T from_key(type bits) noexcept
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            type positive = static_cast<type>(
+              bits >> (std::numeric_limits<type>::digits - 1));
+            bits ^= static_cast<type>(static_cast<type>(positive - 1) |
+                                      sign_bit);
+        }
+        else if constexpr (std::is_signed_v<T>)
+            bits ^= sign_bit;
+
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+};
+
+/**
+ * @brief Positions of the values `-0.0` among values converted to keys.
+ *
+ * Both zeros have the same @ref ordered_key, so algorithms which reconstruct
+ * the sorted values from their keys write `0.0` for every zero. They record
+ * the negative zeros while converting the values and restore them after the
+ * sorted values are written. Nothing is recorded for integers.
+ */
+template <typename T, typename Index>
+class negative_zeros
+{
+public:
+    void record(const T & value, Index position)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            if (value == 0 && std::signbit(value))
+                positions_.push_back(position);
+    }
+
+    /**
+     * @brief Make the zeros of the sorted values negative where the original
+     * value at `index_begin[i]` was.
+     */
+    template <typename RandomIt1, typename RandomIt2>
+    void restore(RandomIt1 value_begin,
+                 RandomIt1 value_end,
+                 RandomIt2 index_begin) const
+    {
+        if (positions_.empty())
+            return;
+
+        // Positions were recorded in ascending order.
+        for (auto i = value_begin; i != value_end; ++i)
+            if (*i == 0 &&
+                std::binary_search(positions_.begin(), positions_.end(),
+                                   static_cast<Index>(
+                                     index_begin[i - value_begin])))
+                *i = -T(0);
+    }
+
+private:
+    std::vector<Index> positions_;
+};
+
+/**
+ * @brief `true` if values of type `T` compared by `Compare` can be sorted by
+ * their @ref ordered_key.
+ */
+template <typename T, typename Compare>
+constexpr bool has_ordered_key_v =
+  ordered_key_supported_v<T> && compare_direction<Compare, T>::supported;
+
+/**
+ * @brief @ref ordered_key which also takes the direction of `Compare` into
+ * account. Descending keys are bitwise negated.
+ */
+template <typename T, typename Compare>
+struct sort_key
+{
+    static_assert(has_ordered_key_v<T, Compare>,
+                  "sort_key requires integers or IEEE floating point numbers "
+                  "compared by std::less or std::greater.");
+
+    using type = typename ordered_key<T>::type;
+
+    static constexpr type flip = compare_direction<Compare, T>::descending
+                                   ? static_cast<type>(~type(0))
+                                   : type(0);
+
+    static type to_key(T value) noexcept
+    {
+        return static_cast<type>(ordered_key<T>::to_key(value) ^ flip);
+    }
+
+    static T from_key(type bits) noexcept
+    {
+        return ordered_key<T>::from_key(static_cast<type>(bits ^ flip));
+    }
+};
+};  // namespace detail
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef PACKED_SORT_
+#define PACKED_SORT_
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "ordered_key.hpp"
+#include "sorting_network.hpp"
+
+namespace indexsort
+{
+/**
+ * Convert values into unsigned integer keys which sort in the same order as
+ * the values (see @ref detail::ordered_key) and pack every key together with
+ * its index into a single contiguous element. Then sort the packed elements
+ * with plain integer comparisons and unpack values and index from them.
+ *
+ * Unlike the algorithms which sort the index with a comparator dereferencing
+ * `value_begin[a]`, every comparison reads only the two packed elements, so the
+ * sort doesn't do random memory accesses into the values. Keys of up to 32 bits
+ * are packed with a 32-bit index into a single `std::uint64_t` if the index
+ * fits. These are sorted in blocks of 64 by a SIMD sorting network (see
+ * @ref detail::sort_network) and the blocks are merged without branches. Other
+ * keys are paired with the index into a `std::pair<key, index>` which is 16
+ * bytes large for `double` and `int`, the same as the
+ * `std::pair<value, index>` of @ref vector_pair_sort, and `std::sort`ed.
+ *
+ * Because the index is compared when keys are equal, equal values keep their
+ * original relative order in the permutation index.
+ *
+ * Only integers and IEEE floating point numbers are supported. `cmp` is never
+ * called, its type is only used to determine the direction of the sort, so it
+ * must be `std::less` or `std::greater`. Like @ref vector_pair_sort, this
+ * algorithm doesn't read the contents of the index iterable.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void packed_sort(RandomIt1 value_begin,
+                 RandomIt1 value_end,
+                 RandomIt2 index_begin,
+                 RandomIt2 index_end,
+                 [[maybe_unused]] Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    static_assert(detail::has_ordered_key_v<value_val_type, Compare>,
+                  "packed_sort() requires integers or IEEE floating point "
+                  "numbers compared by std::less or std::greater.");
+
+    using sort_key = detail::sort_key<value_val_type, Compare>;
+    using key_type = typename sort_key::type;
+
+    using value_diff_type =
+      typename std::iterator_traits<RandomIt1>::difference_type;
+
+    detail::negative_zeros<value_val_type, index_val_type> negative_zeros;
+
+    if constexpr (sizeof(key_type) <= sizeof(std::uint32_t))
+    {
+        if (static_cast<std::uint64_t>(length) <=
+            std::numeric_limits<std::uint32_t>::max())
+        {
+            std::vector<std::uint64_t> packed;
+            packed.reserve(length);
+            std::vector<std::uint64_t> buffer(length);
+            INDEXSORT_COUNT_SCRATCH(2 * length * sizeof(std::uint64_t));
+
+            {
+                INDEXSORT_PHASE("convert");
+
+                std::uint64_t n = 0;
+                for (RandomIt1 i(value_begin); i != value_end; ++i)
+                {
+                    negative_zeros.record(*i, static_cast<index_val_type>(n));
+                    packed.push_back(
+                      (static_cast<std::uint64_t>(sort_key::to_key(*i))
+                       << 32) |
+                      n++);
+                }
+            }
+
+            {
+                INDEXSORT_PHASE("sort");
+                detail::network_merge_sort(packed.data(), buffer.data(),
+                                           packed.size());
+            }
+
+            INDEXSORT_PHASE("apply");
+            for (value_diff_type i = 0; i < length; ++i)
+            {
+                value_begin[i] =
+                  sort_key::from_key(static_cast<key_type>(packed[i] >> 32));
+                index_begin[i] =
+                  static_cast<index_val_type>(packed[i] & 0xffffffffu);
+            }
+            negative_zeros.restore(value_begin, value_end, index_begin);
+            return;
+        }
+    }
+
+    using pair_type = std::pair<key_type, index_val_type>;
+
+    std::vector<pair_type> packed;
+    packed.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(pair_type));
+
+    {
+        INDEXSORT_PHASE("convert");
+
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+        {
+            negative_zeros.record(*i, n);
+            packed.emplace_back(sort_key::to_key(*i), n++);
+        }
+    }
+
+    {
+        INDEXSORT_PHASE("sort");
+        std::sort(packed.begin(), packed.end());
+    }
+
+    INDEXSORT_PHASE("apply");
+    for (value_diff_type i = 0; i < length; ++i)
+    {
+        value_begin[i] = sort_key::from_key(packed[i].first);
+        index_begin[i] = packed[i].second;
+    }
+    negative_zeros.restore(value_begin, value_end, index_begin);
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef PARALLEL_FOR_
+#define PARALLEL_FOR_
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Call `task(i)` for every `i` in `[0, task_count)`, each on its own
+ * thread.
+ *
+ * Task 0 is run on the calling thread. This function returns after all tasks
+ * have finished. If any of the tasks throws, the exception of the task with
+ * the lowest number is rethrown. If a thread can't be started, the tasks
+ * already started are waited for and `std::system_error` is thrown.
+ */
+template <typename Task>
+void parallel_for(unsigned task_count, Task task)
+{
+    if (task_count == 0)
+        return;
+
+    std::vector<std::exception_ptr> exceptions(task_count);
+    std::vector<std::thread> threads;
+    threads.reserve(task_count - 1);
+
+    auto run = [&task, &exceptions](unsigned i)
+    {
+        try
+        {
+            task(i);
+        }
+        catch (...)
+        {
+            exceptions[i] = std::current_exception();
+        }
+    };
+
+    try
+    {
+        for (unsigned i = 1; i < task_count; ++i)
+            threads.emplace_back(run, i);
+    }
+    catch (...)
+    {
+        // Starting a thread failed, destroying a joinable thread would call
+        // std::terminate.
+        for (auto & thread : threads)
+            thread.join();
+        throw;
+    }
+
+    run(0);
+
+    for (auto & thread : threads)
+        thread.join();
+
+    for (auto & exception : exceptions)
+        if (exception)
+            std::rethrow_exception(exception);
+}
+};  // namespace detail
+};  // namespace indexsort
+
+#endif
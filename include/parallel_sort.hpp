@@ -0,0 +1,300 @@
+#ifndef PARALLEL_SORT_
+#define PARALLEL_SORT_
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "parallel_for.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Number of threads worth using for sorting `length` values.
+ *
+ * Inputs that are too small to benefit from threading use fewer threads than
+ * there are hardware threads.
+ */
+inline unsigned default_thread_count(std::size_t length)
+{
+    constexpr std::size_t min_values_per_thread = 1 << 14;
+
+    std::size_t thread_count =
+      std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(
+      thread_count, std::max<std::size_t>(1, length / min_values_per_thread));
+
+    return static_cast<unsigned>(thread_count);
+}
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void parallel_sort_impl(RandomIt1 value_begin,
+                        RandomIt1 value_end,
+                        RandomIt2 index_begin,
+                        RandomIt2 index_end,
+                        Compare cmp,
+                        unsigned thread_count)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    if (length == 0)
+        return;
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using diff_type = typename std::iterator_traits<RandomIt2>::difference_type;
+
+    thread_count = static_cast<unsigned>(
+      std::clamp<diff_type>(thread_count, 1, length));
+
+    auto index_cmp = [&value_begin, &cmp](const index_val_type & a,
+                                          const index_val_type & b)
+    { return cmp(value_begin[a], value_begin[b]); };
+
+    // Chunk i spans [chunk_bounds[i], chunk_bounds[i + 1]) of index.
+    std::vector<diff_type> chunk_bounds(thread_count + 1);
+    for (unsigned i = 0; i <= thread_count; ++i)
+        chunk_bounds[i] = length * i / thread_count;
+
+    // Piece j of chunk i spans [piece_bounds[i][j], piece_bounds[i][j + 1]).
+    std::vector<std::vector<diff_type>> piece_bounds(thread_count);
+
+    // Phases are measured on the calling thread, including the time it waits
+    // for the other threads.
+    {
+        INDEXSORT_PHASE("sort");
+
+        detail::parallel_for(thread_count,
+                             [&](unsigned chunk)
+                             {
+                                 detail::sort<Stable>(
+                                   index_begin + chunk_bounds[chunk],
+                                   index_begin + chunk_bounds[chunk + 1],
+                                   index_cmp);
+                             });
+
+        // Choose pivots from regularly spaced samples of the sorted chunks.
+        std::vector<index_val_type> samples;
+        samples.reserve(thread_count * thread_count);
+        for (unsigned chunk = 0; chunk < thread_count; ++chunk)
+        {
+            diff_type chunk_begin = chunk_bounds[chunk];
+            diff_type chunk_length = chunk_bounds[chunk + 1] - chunk_begin;
+            for (unsigned i = 0; i < thread_count; ++i)
+                samples.push_back(
+                  index_begin[chunk_begin + chunk_length * i / thread_count]);
+        }
+        std::sort(samples.begin(), samples.end(), index_cmp);
+
+        std::vector<index_val_type> pivots;
+        pivots.reserve(thread_count - 1);
+        for (unsigned i = 1; i < thread_count; ++i)
+            pivots.push_back(samples[i * thread_count]);
+
+        detail::parallel_for(
+          thread_count,
+          [&](unsigned chunk)
+          {
+              auto & bounds = piece_bounds[chunk];
+              bounds.reserve(thread_count + 1);
+              bounds.push_back(chunk_bounds[chunk]);
+              for (const auto & pivot : pivots)
+              {
+                  auto chunk_begin = index_begin + bounds.back();
+                  auto chunk_end = index_begin + chunk_bounds[chunk + 1];
+                  bounds.push_back(std::upper_bound(chunk_begin, chunk_end,
+                                                    pivot, index_cmp) -
+                                   index_begin);
+              }
+              bounds.push_back(chunk_bounds[chunk + 1]);
+          });
+    }
+
+    // Piece j of the output spans [output_bounds[j], output_bounds[j + 1]).
+    std::vector<diff_type> output_bounds(thread_count + 1, 0);
+    for (unsigned piece = 0; piece < thread_count; ++piece)
+    {
+        output_bounds[piece + 1] = output_bounds[piece];
+        for (unsigned chunk = 0; chunk < thread_count; ++chunk)
+            output_bounds[piece + 1] += piece_bounds[chunk][piece + 1] -
+                                        piece_bounds[chunk][piece];
+    }
+
+    INDEXSORT_PHASE("apply");
+    INDEXSORT_COUNT_SCRATCH(length *
+                            (sizeof(index_val_type) + sizeof(value_val_type)));
+
+    std::vector<index_val_type> merged_index(length);
+    std::vector<value_val_type> merged_values(length);
+
+    detail::parallel_for(
+      thread_count,
+      [&](unsigned piece)
+      {
+          struct cursor
+          {
+              diff_type position;
+              diff_type end;
+              unsigned chunk;
+          };
+
+          // Heap ordered so that the cursor pointing to the smallest value is
+          // on top. Ties are resolved by chunk order.
+          auto cursor_greater = [&](const cursor & a, const cursor & b)
+          {
+              const auto & a_value = value_begin[index_begin[a.position]];
+              const auto & b_value = value_begin[index_begin[b.position]];
+              if (cmp(b_value, a_value))
+                  return true;
+              if (cmp(a_value, b_value))
+                  return false;
+              return a.chunk > b.chunk;
+          };
+
+          std::vector<cursor> heap;
+          heap.reserve(thread_count);
+          for (unsigned chunk = 0; chunk < thread_count; ++chunk)
+              if (piece_bounds[chunk][piece] != piece_bounds[chunk][piece + 1])
+                  heap.push_back({piece_bounds[chunk][piece],
+                                  piece_bounds[chunk][piece + 1], chunk});
+          std::make_heap(heap.begin(), heap.end(), cursor_greater);
+
+          diff_type output = output_bounds[piece];
+          while (!heap.empty())
+          {
+              std::pop_heap(heap.begin(), heap.end(), cursor_greater);
+              cursor & smallest = heap.back();
+
+              index_val_type source = index_begin[smallest.position];
+              merged_index[output] = source;
+              merged_values[output] = std::move(value_begin[source]);
+              ++output;
+
+              if (++smallest.position == smallest.end)
+                  heap.pop_back();
+              else
+                  std::push_heap(heap.begin(), heap.end(), cursor_greater);
+          }
+      });
+
+    detail::parallel_for(
+      thread_count,
+      [&](unsigned piece)
+      {
+          for (diff_type i = output_bounds[piece]; i < output_bounds[piece + 1];
+               ++i)
+          {
+              value_begin[i] = std::move(merged_values[i]);
+              index_begin[i] = merged_index[i];
+          }
+      });
+}
+};  // namespace detail
+
+/**
+ * Parallel sort by regular sampling. The index is split into `thread_count`
+ * chunks which are `std::sort`ed concurrently with a comparator that uses
+ * values contents instead of index contents. Regularly spaced samples of the
+ * sorted chunks are used to choose `thread_count - 1` pivots which split every
+ * chunk into `thread_count` pieces. Each thread then multiway merges its piece
+ * of every chunk into a temporary index and gathers the corresponding values
+ * into a temporary value buffer. Finally, both buffers are copied back in
+ * parallel.
+ *
+ * The value type must be default constructible.
+ *
+ * @param thread_count Number of threads to use. The calling thread is one of
+ * them. It is limited by the number of values.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void parallel_sort(RandomIt1 value_begin,
+                   RandomIt1 value_end,
+                   RandomIt2 index_begin,
+                   RandomIt2 index_end,
+                   Compare cmp,
+                   unsigned thread_count)
+{
+    detail::parallel_sort_impl<false>(value_begin, value_end, index_begin,
+                                      index_end, cmp, thread_count);
+}
+
+/**
+ * @brief @ref parallel_sort using all available hardware threads.
+ *
+ * Inputs that are too small to benefit from threading use fewer threads.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void parallel_sort(RandomIt1 value_begin,
+                   RandomIt1 value_end,
+                   RandomIt2 index_begin,
+                   RandomIt2 index_end,
+                   Compare cmp)
+{
+    detail::parallel_sort_impl<false>(
+      value_begin, value_end, index_begin, index_end, cmp,
+      detail::default_thread_count(
+        static_cast<std::size_t>(std::distance(value_begin, value_end))));
+}
+
+/**
+ * @brief Stable variation of @ref parallel_sort.
+ *
+ * Chunks are sorted with `std::stable_sort` instead of `std::sort`. The
+ * multiway merge already resolves ties by chunk order, so equal values keep
+ * their original relative order in the permutation index.
+ *
+ * @param thread_count Number of threads to use. The calling thread is one of
+ * them. It is limited by the number of values.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_parallel_sort(RandomIt1 value_begin,
+                          RandomIt1 value_end,
+                          RandomIt2 index_begin,
+                          RandomIt2 index_end,
+                          Compare cmp,
+                          unsigned thread_count)
+{
+    detail::parallel_sort_impl<true>(value_begin, value_end, index_begin,
+                                     index_end, cmp, thread_count);
+}
+
+/**
+ * @brief @ref stable_parallel_sort using all available hardware threads.
+ *
+ * Inputs that are too small to benefit from threading use fewer threads.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_parallel_sort(RandomIt1 value_begin,
+                          RandomIt1 value_end,
+                          RandomIt2 index_begin,
+                          RandomIt2 index_end,
+                          Compare cmp)
+{
+    detail::parallel_sort_impl<true>(
+      value_begin, value_end, index_begin, index_end, cmp,
+      detail::default_thread_count(
+        static_cast<std::size_t>(std::distance(value_begin, value_end))));
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef PARTIAL_SORT_
+#define PARTIAL_SORT_
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+
+namespace indexsort
+{
+/**
+ * Sort only the first `k` values. `std::nth_element` the index with a custom
+ * comparator that uses values contents instead of index contents to select the
+ * `k` smallest values, then `std::sort` just those `k` indexes. This takes
+ * O(n + k log k) time instead of O(n log n).
+ *
+ * After the call, the first `k` values are the `k` smallest values in sorted
+ * order and the first `k` elements of the index are their original positions.
+ * The index of the remaining elements is restored to the original sequence and
+ * the remaining values are left where they were, except for the positions of
+ * the selected values which are filled with the values displaced from the
+ * first `k` positions. `value_begin[i]` is therefore the original value at
+ * position `index_begin[i]` for every `i`, but at most `2 * k` values are
+ * moved.
+ *
+ * @param k Number of values to sort. It is limited by the number of values.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void partial_index_sort(
+  RandomIt1 value_begin,
+  RandomIt1 value_end,
+  RandomIt2 index_begin,
+  RandomIt2 index_end,
+  typename std::iterator_traits<RandomIt1>::difference_type k,
+  Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    k = std::clamp<decltype(length)>(k, 0, length);
+    if (k == 0)
+        return;
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    auto index_cmp = [&value_begin, &cmp](const index_val_type & a,
+                                          const index_val_type & b)
+    { return cmp(value_begin[a], value_begin[b]); };
+
+    {
+        INDEXSORT_PHASE("sort");
+        if (k < length)
+            std::nth_element(index_begin, index_begin + k, index_end,
+                             index_cmp);
+        std::sort(index_begin, index_begin + k, index_cmp);
+    }
+
+    INDEXSORT_PHASE("apply");
+    INDEXSORT_COUNT_SCRATCH(k * (sizeof(index_val_type) +
+                                 sizeof(value_val_type)));
+
+    std::vector<index_val_type> top(index_begin, index_begin + k);
+    std::vector<value_val_type> top_values;
+    top_values.reserve(k);
+    for (const auto & position : top)
+        top_values.push_back(std::move(value_begin[position]));
+
+    std::iota(index_begin + k, index_end, static_cast<index_val_type>(k));
+
+    // Move values from the first k positions which weren't selected to the
+    // positions of selected values which are outside of the first k positions.
+    using diff_type = decltype(length);
+
+    std::vector<bool> selected(k, false);
+    for (const auto & position : top)
+        if (static_cast<diff_type>(position) < k)
+            selected[position] = true;
+
+    diff_type displaced = 0;
+    for (const auto & position : top)
+    {
+        if (static_cast<diff_type>(position) < k)
+            continue;
+
+        while (selected[displaced])
+            ++displaced;
+
+        value_begin[position] = std::move(value_begin[displaced]);
+        index_begin[position] = static_cast<index_val_type>(displaced);
+        ++displaced;
+    }
+
+    for (diff_type i = 0; i < k; ++i)
+    {
+        value_begin[i] = std::move(top_values[i]);
+        index_begin[i] = top[i];
+    }
+}
+};  // namespace indexsort
+
+#endif
@@ -6,35 +6,27 @@
 #include <vector>
 
 #include "base.hpp"
+#include "instrumentation.hpp"
 
 namespace indexsort
 {
+namespace detail
+{
 /**
- * `std::sort` index with custom comparator that uses values contents instead of
- * index contents. Then apply the permutation index in place to values.
+ * @brief Apply the permutation index to values in place without modifying the
+ * index.
  *
- * This algorithm is taken from
- * https://medium.com/@kevingxyz/permutation-in-place-8528581a5553
+ * The value that belongs to position `i` is found by following the index
+ * from `index[i]` until it points to a position that hasn't been processed
+ * yet. It is then swapped into place.
  */
-template <typename RandomIt1, typename RandomIt2, typename Compare>
-void permutate_in_place_sort(RandomIt1 value_begin,
-                             RandomIt1 value_end,
-                             RandomIt2 index_begin,
-                             RandomIt2 index_end,
-                             Compare cmp)
+template <typename RandomIt1, typename RandomIt2, typename Diff>
+void permutate_in_place(RandomIt1 value_begin,
+                        RandomIt2 index_begin,
+                        Diff length)
 {
-    auto length = std::distance(value_begin, value_end);
-
-    if (length != std::distance(index_begin, index_end))
-        throw length_mismatch_error("Length of both iterables must match!");
-
     using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
 
-    std::sort(
-      index_begin, index_end,
-      [&value_begin, &cmp](const index_val_type & a, const index_val_type & b)
-      { return cmp(value_begin[a], value_begin[b]); });
-
     // We'll be using these two as if they were arrays. Rename them for
     // convenience.
     auto & index = index_begin;
@@ -50,6 +42,73 @@ void permutate_in_place_sort(RandomIt1 value_begin,
         swap(values[i], values[index_to_swap]);
     }
 }
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void permutate_in_place_sort_impl(RandomIt1 value_begin,
+                                  RandomIt1 value_end,
+                                  RandomIt2 index_begin,
+                                  RandomIt2 index_end,
+                                  Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::sort<Stable>(index_begin, index_end,
+                             [&value_begin, &cmp](const index_val_type & a,
+                                                  const index_val_type & b)
+                             { return cmp(value_begin[a], value_begin[b]); });
+    }
+
+    INDEXSORT_PHASE("apply");
+    detail::permutate_in_place(value_begin, index_begin, length);
+}
+};  // namespace detail
+
+/**
+ * `std::sort` index with custom comparator that uses values contents instead of
+ * index contents. Then apply the permutation index in place to values.
+ *
+ * This algorithm is taken from
+ * https://medium.com/@kevingxyz/permutation-in-place-8528581a5553
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void permutate_in_place_sort(RandomIt1 value_begin,
+                             RandomIt1 value_end,
+                             RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             Compare cmp)
+{
+    detail::permutate_in_place_sort_impl<false>(
+      value_begin, value_end, index_begin, index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref permutate_in_place_sort.
+ *
+ * The index is sorted with `std::stable_sort` instead of `std::sort`, so equal
+ * values keep their original relative order in the permutation index. The
+ * permutation is then applied in place the same way as in
+ * @ref permutate_in_place_sort.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_permutate_in_place_sort(RandomIt1 value_begin,
+                                    RandomIt1 value_end,
+                                    RandomIt2 index_begin,
+                                    RandomIt2 index_end,
+                                    Compare cmp)
+{
+    detail::permutate_in_place_sort_impl<true>(
+      value_begin, value_end, index_begin, index_end, cmp);
+}
 };  // namespace indexsort
 
 #endif
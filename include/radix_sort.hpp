@@ -0,0 +1,153 @@
+#ifndef RADIX_SORT_
+#define RADIX_SORT_
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "ordered_key.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief LSD radix sort `keys` and permute `index` alongside them.
+ *
+ * Keys are sorted one byte at a time starting from the least significant one.
+ * Histograms of all bytes are computed in a single pass over the keys. Passes
+ * in which all keys share the same byte are skipped. The sort is stable.
+ */
+template <typename Key, typename Index>
+void radix_sort_keys(std::vector<Key> & keys, std::vector<Index> & index)
+{
+    constexpr std::size_t radix = 256;
+    constexpr std::size_t passes = sizeof(Key);
+
+    const std::size_t length = keys.size();
+
+    std::array<std::array<std::size_t, radix>, passes> histograms{};
+    for (Key key : keys)
+        for (std::size_t pass = 0; pass < passes; ++pass)
+            ++histograms[pass][(key >> (pass * 8)) & (radix - 1)];
+
+    std::vector<Key> keys_buffer(length);
+    std::vector<Index> index_buffer(length);
+
+    for (std::size_t pass = 0; pass < passes; ++pass)
+    {
+        auto & histogram = histograms[pass];
+
+        // Every key has the same byte at this position, the pass wouldn't
+        // change anything.
+        if (histogram[(keys.front() >> (pass * 8)) & (radix - 1)] == length)
+            continue;
+
+        std::size_t offset = 0;
+        for (auto & count : histogram)
+        {
+            std::size_t bucket_size = count;
+            count = offset;
+            offset += bucket_size;
+        }
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            std::size_t target =
+              histogram[(keys[i] >> (pass * 8)) & (radix - 1)]++;
+            keys_buffer[target] = keys[i];
+            index_buffer[target] = index[i];
+        }
+
+        keys.swap(keys_buffer);
+        index.swap(index_buffer);
+    }
+}
+};  // namespace detail
+
+/**
+ * Convert values into unsigned integer keys which sort in the same order as
+ * the values (see @ref detail::ordered_key). Then LSD radix sort the keys
+ * together with the index one byte at a time. The result is reconstructed from
+ * the sorted keys. This takes O(n * sizeof(value)) time instead of O(n log n)
+ * comparisons.
+ *
+ * Only integers and IEEE floating point numbers are supported. `cmp` is never
+ * called, its type is only used to determine the direction of the sort, so it
+ * must be `std::less` or `std::greater`. Radix sort is stable, equal values
+ * keep their original relative order in the permutation index.
+ *
+ * Like @ref vector_pair_sort, this algorithm doesn't read the contents of the
+ * index iterable.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void radix_sort(RandomIt1 value_begin,
+                RandomIt1 value_end,
+                RandomIt2 index_begin,
+                RandomIt2 index_end,
+                [[maybe_unused]] Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    static_assert(detail::has_ordered_key_v<value_val_type, Compare>,
+                  "radix_sort() requires integers or IEEE floating point "
+                  "numbers compared by std::less or std::greater.");
+
+    if (length == 0)
+        return;
+
+    using sort_key = detail::sort_key<value_val_type, Compare>;
+
+    std::vector<typename sort_key::type> keys;
+    std::vector<index_val_type> index;
+    keys.reserve(length);
+    index.reserve(length);
+    // The keys and the index, and the buffers of radix_sort_keys().
+    INDEXSORT_COUNT_SCRATCH(
+      2 * length * (sizeof(typename sort_key::type) + sizeof(index_val_type)));
+
+    detail::negative_zeros<value_val_type, index_val_type> negative_zeros;
+
+    {
+        INDEXSORT_PHASE("convert");
+
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+        {
+            negative_zeros.record(*i, n);
+            keys.push_back(sort_key::to_key(*i));
+            index.push_back(n++);
+        }
+    }
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::radix_sort_keys(keys, index);
+    }
+
+    INDEXSORT_PHASE("apply");
+    using value_diff_type =
+      typename std::iterator_traits<RandomIt1>::difference_type;
+
+    for (value_diff_type i = 0; i < length; ++i)
+    {
+        value_begin[i] = sort_key::from_key(keys[i]);
+        index_begin[i] = index[i];
+    }
+    negative_zeros.restore(value_begin, value_end, index_begin);
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef RANK_
+#define RANK_
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "ordered_key.hpp"
+#include "radix_sort.hpp"
+
+namespace indexsort
+{
+/**
+ * @brief How equal values are ranked.
+ *
+ * For the values `{7, 45, 7, 33}`:
+ * - `ordinal`: every value has its own rank and equal values are ranked by
+ *   their position, `{0, 3, 1, 2}`. This is the inverse of the permutation
+ *   index returned by the sorting algorithms.
+ * - `min`: equal values share the lowest of their ordinal ranks and the next
+ *   distinct value skips the ranks in between, `{0, 3, 0, 2}`.
+ * - `dense`: equal values share a rank and distinct values have consecutive
+ *   ranks, `{0, 2, 0, 1}`.
+ */
+enum class rank_mode
+{
+    ordinal,
+    min,
+    dense
+};
+
+namespace detail
+{
+/**
+ * @brief Write the rank of the `i`-th smallest value to
+ * `rank_begin[position(i)]` for every `i`. `tied(i)` tells whether the `i`-th
+ * smallest value is equal to the previous one, it's only called if `Mode`
+ * needs it.
+ */
+template <rank_mode Mode,
+          typename Diff,
+          typename Position,
+          typename Tied,
+          typename RandomIt3>
+void scatter_ranks(Diff length,
+                   Position position,
+                   Tied tied,
+                   RandomIt3 rank_begin)
+{
+    using rank_val_type = typename std::iterator_traits<RandomIt3>::value_type;
+
+    rank_val_type shared = 0;
+    for (Diff i = 0; i < length; ++i)
+    {
+        if constexpr (Mode == rank_mode::ordinal)
+            shared = static_cast<rank_val_type>(i);
+        else if (i != 0 && !tied(i))
+            shared = Mode == rank_mode::min ? static_cast<rank_val_type>(i)
+                                            : shared + 1;
+
+        rank_begin[position(i)] = shared;
+    }
+}
+
+/**
+ * @brief @ref scatter_ranks with the mode chosen at runtime. The loop is
+ * instantiated for every mode, so it doesn't branch on the mode.
+ */
+template <typename Diff, typename Position, typename Tied, typename RandomIt3>
+void scatter_ranks(rank_mode mode,
+                   Diff length,
+                   Position position,
+                   Tied tied,
+                   RandomIt3 rank_begin)
+{
+    switch (mode)
+    {
+    case rank_mode::ordinal:
+        scatter_ranks<rank_mode::ordinal>(length, position, tied, rank_begin);
+        break;
+    case rank_mode::min:
+        scatter_ranks<rank_mode::min>(length, position, tied, rank_begin);
+        break;
+    case rank_mode::dense:
+        scatter_ranks<rank_mode::dense>(length, position, tied, rank_begin);
+        break;
+    }
+}
+
+template <typename RandomIt1, typename RandomIt3>
+void check_rank_length(RandomIt1 value_begin,
+                       RandomIt1 value_end,
+                       RandomIt3 rank_begin,
+                       RandomIt3 rank_end)
+{
+    if (std::distance(value_begin, value_end) !=
+        std::distance(rank_begin, rank_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+}
+};  // namespace detail
+
+/**
+ * Compute the rank of every value, the position it would have after sorting,
+ * without moving any values. Ranks are written to `rank_begin` in the order of
+ * the values and ties are resolved by `mode`.
+ *
+ * Computing ranks by inverting the index of @ref argsort needs a second pass
+ * which reads the index and, for ties, the values in sorted order scattered
+ * over memory. Here the ranks are written in the same pass over the sorted
+ * keys which detects ties. Integers and IEEE floating point numbers compared
+ * by `std::less` or `std::greater` are radix sorted as in @ref radix_sort,
+ * other values are sorted by `std::stable_sort`ing positions, so equal values
+ * are ranked by their position.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(rank_begin, rank_end)`.
+ */
+template <typename RandomIt1, typename RandomIt3, typename Compare>
+void argrank(RandomIt1 value_begin,
+             RandomIt1 value_end,
+             RandomIt3 rank_begin,
+             RandomIt3 rank_end,
+             Compare cmp,
+             rank_mode mode = rank_mode::ordinal)
+{
+    detail::check_rank_length(value_begin, value_end, rank_begin, rank_end);
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using rank_val_type = typename std::iterator_traits<RandomIt3>::value_type;
+    using value_diff_type =
+      typename std::iterator_traits<RandomIt1>::difference_type;
+
+    value_diff_type length = std::distance(value_begin, value_end);
+
+    if constexpr (detail::has_ordered_key_v<value_val_type, Compare>)
+    {
+        using sort_key = detail::sort_key<value_val_type, Compare>;
+
+        std::vector<typename sort_key::type> keys;
+        std::vector<rank_val_type> positions;
+        keys.reserve(length);
+        positions.reserve(length);
+        INDEXSORT_COUNT_SCRATCH(length * (sizeof(typename sort_key::type) +
+                                          sizeof(rank_val_type)));
+
+        {
+            INDEXSORT_PHASE("sort");
+
+            rank_val_type n = 0;
+            for (RandomIt1 i(value_begin); i != value_end; ++i)
+            {
+                keys.push_back(sort_key::to_key(*i));
+                positions.push_back(n++);
+            }
+
+            if (length != 0)
+                detail::radix_sort_keys(keys, positions);
+        }
+
+        INDEXSORT_PHASE("rank");
+        detail::scatter_ranks(
+          mode, length,
+          [&positions](value_diff_type i) { return positions[i]; },
+          [&keys, &cmp](value_diff_type i)
+          {
+              // Keys differ for NaNs with different bits, the comparator
+              // decides ties.
+              return !cmp(sort_key::from_key(keys[i - 1]),
+                          sort_key::from_key(keys[i]));
+          },
+          rank_begin);
+    }
+    else
+    {
+        std::vector<rank_val_type> positions(length);
+        std::iota(positions.begin(), positions.end(), 0);
+        INDEXSORT_COUNT_SCRATCH(length * sizeof(rank_val_type));
+
+        {
+            INDEXSORT_PHASE("sort");
+            detail::sort<true>(positions.begin(), positions.end(),
+                               [&value_begin, &cmp](const rank_val_type & a,
+                                                    const rank_val_type & b)
+                               { return cmp(value_begin[a], value_begin[b]); });
+        }
+
+        INDEXSORT_PHASE("rank");
+        detail::scatter_ranks(
+          mode, length,
+          [&positions](value_diff_type i) { return positions[i]; },
+          [&value_begin, &positions, &cmp](value_diff_type i)
+          {
+              return !cmp(value_begin[positions[i - 1]],
+                          value_begin[positions[i]]);
+          },
+          rank_begin);
+    }
+}
+
+/**
+ * Sort values and compute both the permutation index and the rank of every
+ * original value. After the call, `value_begin[i]` is the
+ * original `value_begin[index_begin[i]]` and the original `value_begin[j]`
+ * ended up at position `rank_begin[j]` if `mode` is `rank_mode::ordinal`.
+ * Other modes give equal values a shared rank, see @ref rank_mode.
+ *
+ * Values are sorted stably as pairs like in @ref vector_pair_sort, or radix
+ * sorted like in @ref radix_sort when that's possible. Ranks are scattered
+ * right after the sorted values are written back, and ties are found by
+ * comparing neighbouring sorted values, which are contiguous, instead of
+ * reading values through the index.
+ *
+ * Values are never copied, so move-only types are supported.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end)` isn't equal to `std::distance(index_begin, index_end)` and
+ * `std::distance(rank_begin, rank_end)`.
+ */
+template <typename RandomIt1,
+          typename RandomIt2,
+          typename RandomIt3,
+          typename Compare>
+void rank_sort(RandomIt1 value_begin,
+               RandomIt1 value_end,
+               RandomIt2 index_begin,
+               RandomIt2 index_end,
+               RandomIt3 rank_begin,
+               RandomIt3 rank_end,
+               Compare cmp,
+               rank_mode mode = rank_mode::ordinal)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+    detail::check_rank_length(value_begin, value_end, rank_begin, rank_end);
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using value_diff_type =
+      typename std::iterator_traits<RandomIt1>::difference_type;
+
+    if constexpr (detail::has_ordered_key_v<value_val_type, Compare>)
+    {
+        using sort_key = detail::sort_key<value_val_type, Compare>;
+
+        std::vector<typename sort_key::type> keys;
+        std::vector<index_val_type> index;
+        keys.reserve(length);
+        index.reserve(length);
+        INDEXSORT_COUNT_SCRATCH(length * (sizeof(typename sort_key::type) +
+                                          sizeof(index_val_type)));
+
+        detail::negative_zeros<value_val_type, index_val_type> negative_zeros;
+
+        {
+            INDEXSORT_PHASE("sort");
+
+            index_val_type n = 0;
+            for (RandomIt1 i(value_begin); i != value_end; ++i)
+            {
+                negative_zeros.record(*i, n);
+                keys.push_back(sort_key::to_key(*i));
+                index.push_back(n++);
+            }
+
+            if (length != 0)
+                detail::radix_sort_keys(keys, index);
+        }
+
+        INDEXSORT_PHASE("rank");
+        for (value_diff_type i = 0; i < length; ++i)
+        {
+            value_begin[i] = sort_key::from_key(keys[i]);
+            index_begin[i] = index[i];
+        }
+        negative_zeros.restore(value_begin, value_end, index_begin);
+
+        detail::scatter_ranks(
+          mode, length, [&index](value_diff_type i) { return index[i]; },
+          [&value_begin, &cmp](value_diff_type i)
+          { return !cmp(value_begin[i - 1], value_begin[i]); },
+          rank_begin);
+    }
+    else
+    {
+        using pair_type = std::pair<value_val_type, index_val_type>;
+
+        std::vector<pair_type> conversion;
+        conversion.reserve(length);
+        INDEXSORT_COUNT_SCRATCH(length * sizeof(pair_type));
+
+        {
+            INDEXSORT_PHASE("sort");
+
+            index_val_type n = 0;
+            for (RandomIt1 i(value_begin); i != value_end; ++i)
+                conversion.emplace_back(std::move(*i), n++);
+
+            detail::sort<true>(conversion.begin(), conversion.end(),
+                               [&cmp](const pair_type & a, const pair_type & b)
+                               { return cmp(a.first, b.first); });
+        }
+
+        INDEXSORT_PHASE("rank");
+        for (value_diff_type i = 0; i < length; ++i)
+        {
+            value_begin[i] = std::move(conversion[i].first);
+            index_begin[i] = conversion[i].second;
+        }
+
+        detail::scatter_ranks(
+          mode, length,
+          [&conversion](value_diff_type i) { return conversion[i].second; },
+          [&value_begin, &cmp](value_diff_type i)
+          { return !cmp(value_begin[i - 1], value_begin[i]); },
+          rank_begin);
+    }
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef SCRATCH_ARENA_
+#define SCRATCH_ARENA_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+
+namespace indexsort
+{
+/**
+ * @brief Reusable memory for the temporary buffers of index sort algorithms.
+ *
+ * The arena owns a single block of memory and hands out consecutive pieces of
+ * it. Allocations that don't fit fall back to `::operator new`. When all
+ * allocations have been released, the arena rewinds to the beginning of its
+ * block. If the allocations didn't fit, the next allocation grows the block so
+ * that the same sequence of allocations fits. After the first call of an
+ * algorithm, repeated calls with inputs of the same size allocate only once
+ * more, when the block grows at the start of the second call.
+ *
+ * The arena isn't thread safe. It must outlive all allocators using it.
+ *
+ * Use it through @ref arena_allocator.
+ */
+class scratch_arena
+{
+public:
+    scratch_arena() = default;
+
+    /**
+     * @brief Create an arena with a block of `capacity` bytes.
+     */
+    explicit scratch_arena(std::size_t capacity)
+    {
+        grow(capacity);
+    }
+
+    scratch_arena(const scratch_arena &) = delete;
+    scratch_arena & operator=(const scratch_arena &) = delete;
+
+    void * allocate(std::size_t bytes, std::size_t alignment)
+    {
+        // Growing frees the block, which is only possible when no piece of it
+        // is in use. Deallocation can't grow it, because it mustn't throw.
+        if (live_ == 0 && required_ > capacity_)
+        {
+            grow(required_);
+            required_ = 0;
+        }
+
+        // Memory that the allocation would need if the block was empty. This
+        // is an upper bound, the block is aligned to the default alignment.
+        demand_ += bytes + alignment;
+
+        void * memory = buffer_.get() + offset_;
+        std::size_t space = capacity_ - offset_;
+        if (buffer_ && std::align(alignment, bytes, memory, space))
+        {
+            offset_ = capacity_ - space + bytes;
+            ++live_;
+            return memory;
+        }
+
+        memory = ::operator new(bytes, std::align_val_t(alignment));
+        ++live_;
+        return memory;
+    }
+
+    void deallocate(void * memory,
+                    [[maybe_unused]] std::size_t bytes,
+                    std::size_t alignment) noexcept
+    {
+        auto * byte_memory = static_cast<std::byte *>(memory);
+        std::less<std::byte *> less;
+        if (less(byte_memory, buffer_.get()) ||
+            !less(byte_memory, buffer_.get() + capacity_))
+            ::operator delete(memory, std::align_val_t(alignment));
+
+        if (--live_ == 0)
+        {
+            if (demand_ > capacity_)
+                required_ = std::max(required_, demand_);
+            offset_ = 0;
+            demand_ = 0;
+        }
+    }
+
+    /**
+     * @brief Size of the block of memory owned by the arena in bytes.
+     */
+    std::size_t capacity() const noexcept
+    {
+        return capacity_;
+    }
+
+private:
+    void grow(std::size_t capacity)
+    {
+        buffer_.reset(new std::byte[capacity]);
+        capacity_ = capacity;
+    }
+
+    std::unique_ptr<std::byte[]> buffer_;
+    std::size_t capacity_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t live_ = 0;
+    std::size_t demand_ = 0;
+    std::size_t required_ = 0;
+};
+
+/**
+ * @brief Allocator which allocates memory from a @ref scratch_arena.
+ *
+ * Copies of the allocator (including rebound copies) share the arena.
+ */
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+    explicit arena_allocator(scratch_arena & arena) noexcept : arena_(&arena)
+    {
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U> & other) noexcept
+      : arena_(&other.arena())
+    {
+    }
+
+    T * allocate(std::size_t n)
+    {
+        return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T * memory, std::size_t n) noexcept
+    {
+        arena_->deallocate(memory, n * sizeof(T), alignof(T));
+    }
+
+    scratch_arena & arena() const noexcept
+    {
+        return *arena_;
+    }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U> & other) const noexcept
+    {
+        return arena_ == &other.arena();
+    }
+
+    template <typename U>
+    bool operator!=(const arena_allocator<U> & other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+private:
+    scratch_arena * arena_;
+};
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef SORT_
+#define SORT_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "base.hpp"
+#include "branchless_quick_sort.hpp"
+#include "cycle_apply_sort.hpp"
+#include "narrow_index.hpp"
+#include "ordered_key.hpp"
+#include "radix_sort.hpp"
+#include "vector_pair_sort.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Thresholds used by @ref indexsort::sort to pick an algorithm.
+ *
+ * They were calibrated with the "Benchmark dispatcher thresholds" benchmark.
+ */
+struct dispatch_thresholds
+{
+    /**
+     * Below this length, building radix histograms of 8-byte keys costs more
+     * than the comparison sort saves.
+     */
+    static constexpr std::ptrdiff_t radix_min_length = 1024;
+
+    /**
+     * Above this length, radix sorting 8-byte keys stops winning because each
+     * of its passes streams the whole key and index buffers through memory.
+     */
+    static constexpr std::ptrdiff_t wide_radix_max_length = 1 << 18;
+
+    /**
+     * Values larger than this are expensive to move, so they are moved only
+     * once after sorting the index instead of being sorted in pairs.
+     */
+    static constexpr std::size_t large_value_size = 64;
+
+    /**
+     * Below this length, the index and the values fit into cache and sorting
+     * the index and then moving every value once beats sorting pairs.
+     */
+    static constexpr std::ptrdiff_t pair_min_length = 1024;
+};
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void dispatch_sort(RandomIt1 value_begin,
+                   RandomIt1 value_end,
+                   RandomIt2 index_begin,
+                   RandomIt2 index_end,
+                   Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using thresholds = dispatch_thresholds;
+
+    if constexpr (has_ordered_key_v<value_val_type, Compare>)
+    {
+        // Both radix sort and branchless quick sort are stable. Keys of up to
+        // 32 bits are packed with their index, which branchless quick sort
+        // sorts at least as fast as radix sort at every length. Packing uses
+        // a 32-bit position whatever the index type is, and the radix length
+        // thresholds are the same for 32 and 64-bit indexes.
+        using key_type = typename sort_key<value_val_type, Compare>::type;
+
+        bool use_radix = sizeof(key_type) > sizeof(std::uint32_t) &&
+                         length >= thresholds::radix_min_length &&
+                         length <= thresholds::wide_radix_max_length;
+
+        if (use_radix)
+            radix_sort(value_begin, value_end, index_begin, index_end, cmp);
+        else
+            branchless_quick_sort(value_begin, value_end, index_begin,
+                                  index_end, cmp);
+    }
+    else
+    {
+        // A wide index makes the pairs larger than a 32-bit position would,
+        // so every step of the sort would move more memory.
+        constexpr bool narrow_pairs =
+          sizeof(index_pair_t<value_val_type, std::uint32_t>) <
+          sizeof(std::pair<value_val_type, index_val_type>);
+
+        if (sizeof(value_val_type) > thresholds::large_value_size ||
+            length < thresholds::pair_min_length)
+        {
+            cycle_apply_sort_impl<Stable>(value_begin, value_end, index_begin,
+                                          index_end, cmp);
+        }
+        else if constexpr (narrow_pairs)
+        {
+            narrow_vector_pair_sort_impl<Stable>(value_begin, value_end,
+                                                 index_begin, index_end, cmp);
+        }
+        else
+        {
+            vector_pair_sort_impl<Stable>(value_begin, value_end, index_begin,
+                                          index_end, cmp,
+                                          std::allocator<char>());
+        }
+    }
+}
+};  // namespace detail
+
+/**
+ * Sort with the algorithm that is expected to be the fastest one for the value
+ * type, the comparator and the length of the input.
+ *
+ * The choice between algorithms is made at compile time from the value type,
+ * the index type and `Compare`, and at run time from the length:
+ *
+ * - Integers and IEEE floating point numbers compared by `std::less` or
+ *   `std::greater` are sorted by @ref branchless_quick_sort, except for 8-byte
+ *   keys of medium length, which are sorted by @ref radix_sort.
+ * - Values larger than 64 bytes and short inputs are sorted by
+ *   @ref cycle_apply_sort, which moves every value at most twice.
+ * - Everything else is sorted by @ref vector_pair_sort, or by
+ *   @ref narrow_vector_pair_sort if the index type is wider than 32 bits and
+ *   a 32-bit position makes the pairs smaller, like for `int` values with a
+ *   `std::int64_t` index.
+ *
+ * The index type doesn't affect integers and floating point numbers, which
+ * are packed with a 32-bit position or radix sorted with the same thresholds
+ * for 32 and 64-bit indexes.
+ *
+ * The thresholds are listed in @ref detail::dispatch_thresholds.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void sort(RandomIt1 value_begin,
+          RandomIt1 value_end,
+          RandomIt2 index_begin,
+          RandomIt2 index_end,
+          Compare cmp)
+{
+    detail::dispatch_sort<false>(value_begin, value_end, index_begin,
+                                 index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref sort.
+ *
+ * The same algorithms are chosen, but their stable variations are used, so
+ * equal values keep their original relative order in the permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_sort(RandomIt1 value_begin,
+                 RandomIt1 value_end,
+                 RandomIt2 index_begin,
+                 RandomIt2 index_end,
+                 Compare cmp)
+{
+    detail::dispatch_sort<true>(value_begin, value_end, index_begin, index_end,
+                                cmp);
+}
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef SORTING_NETWORK_
+#define SORTING_NETWORK_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define INDEXSORT_X86_SIMD_NETWORK 1
+#else
+#define INDEXSORT_X86_SIMD_NETWORK 0
+#endif
+
+#if defined(__GNUC__)
+#define INDEXSORT_ALWAYS_INLINE __attribute__((always_inline)) inline
+#elif defined(_MSC_VER)
+#define INDEXSORT_ALWAYS_INLINE __forceinline
+#else
+#define INDEXSORT_ALWAYS_INLINE inline
+#endif
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Largest number of elements sorted by @ref sort_network.
+ */
+constexpr std::size_t sorting_network_max_length = 64;
+
+/**
+ * @brief Bitonic sorting network over `N` elements of `data` held in vectors
+ * of type `V`.
+ *
+ * `V` is either `std::uint64_t` (the scalar fallback) or, with
+ * `INDEXSORT_X86_SIMD_NETWORK`, a GCC vector of `std::uint64_t`.
+ * Compare-exchanges between elements which are at least one vector apart are
+ * done with whole vector minimums and maximums. Those within a vector shuffle
+ * the vector against itself and blend the minimum and the maximum. There are
+ * no data dependent branches.
+ *
+ * This function is always inlined, so that it is compiled for the instruction
+ * set of the function calling it.
+ */
+template <std::size_t N, typename V>
+INDEXSORT_ALWAYS_INLINE void bitonic_network(std::uint64_t * data)
+{
+    constexpr std::size_t width = sizeof(V) / sizeof(std::uint64_t);
+    constexpr std::size_t count = N / width;
+    static_assert(N % width == 0, "N must be a multiple of the vector width");
+
+    V vectors[count];
+    std::memcpy(vectors, data, sizeof(vectors));
+
+    for (std::size_t k = 2; k <= N; k *= 2)
+    {
+        for (std::size_t j = k / 2; j > 0; j /= 2)
+        {
+            if (j >= width)
+            {
+                // Partners are in different vectors, at the same lane.
+                std::size_t vector_distance = j / width;
+                for (std::size_t v = 0; v < count; ++v)
+                {
+                    std::size_t partner = v ^ vector_distance;
+                    if (partner < v)
+                        continue;
+
+                    V low = vectors[v] < vectors[partner] ? vectors[v]
+                                                          : vectors[partner];
+                    V high = vectors[v] < vectors[partner] ? vectors[partner]
+                                                           : vectors[v];
+                    bool ascending = ((v * width) & k) == 0;
+                    vectors[v] = ascending ? low : high;
+                    vectors[partner] = ascending ? high : low;
+                }
+            }
+#if INDEXSORT_X86_SIMD_NETWORK
+            // Vector lanes and shuffles are GCC extensions, other compilers
+            // only instantiate the scalar network, whose width is 1.
+            else if constexpr (width > 1)
+            {
+                // Partners are in the same vector.
+                V lanes;
+                for (std::size_t lane = 0; lane < width; ++lane)
+                    lanes[lane] = lane;
+
+                V partner_lanes = lanes ^ j;
+                auto lower = (lanes & j) == 0;
+
+                for (std::size_t v = 0; v < count; ++v)
+                {
+                    V partners = __builtin_shuffle(vectors[v], partner_lanes);
+                    V low = vectors[v] < partners ? vectors[v] : partners;
+                    V high = vectors[v] < partners ? partners : vectors[v];
+                    auto ascending = ((v * width + lanes) & k) == 0;
+                    vectors[v] = (lower == ascending) ? low : high;
+                }
+            }
+#endif
+        }
+    }
+
+    std::memcpy(data, vectors, sizeof(vectors));
+}
+
+#if INDEXSORT_X86_SIMD_NETWORK
+typedef std::uint64_t uint64x4_t __attribute__((vector_size(32)));
+typedef std::uint64_t uint64x8_t __attribute__((vector_size(64)));
+
+template <std::size_t N>
+__attribute__((target("avx2"))) void bitonic_network_avx2(
+  std::uint64_t * data)
+{
+    bitonic_network<N, uint64x4_t>(data);
+}
+
+template <std::size_t N>
+__attribute__((target("avx512f"))) void bitonic_network_avx512(
+  std::uint64_t * data)
+{
+    bitonic_network<N, uint64x8_t>(data);
+}
+#endif
+
+/**
+ * @brief Instruction set used by @ref sort_network.
+ */
+enum class network_isa
+{
+    scalar,
+    avx2,
+    avx512
+};
+
+/**
+ * @brief Best instruction set supported by the CPU, detected once with CPUID.
+ */
+inline network_isa detected_network_isa()
+{
+#if INDEXSORT_X86_SIMD_NETWORK
+    static const network_isa isa = []
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return network_isa::avx512;
+        if (__builtin_cpu_supports("avx2"))
+            return network_isa::avx2;
+        return network_isa::scalar;
+    }();
+    return isa;
+#else
+    return network_isa::scalar;
+#endif
+}
+
+template <std::size_t N>
+void bitonic_network_dispatch(std::uint64_t * data, network_isa isa)
+{
+#if INDEXSORT_X86_SIMD_NETWORK
+    if (isa == network_isa::avx512)
+        return bitonic_network_avx512<N>(data);
+    if (isa == network_isa::avx2)
+        return bitonic_network_avx2<N>(data);
+#else
+    static_cast<void>(isa);
+#endif
+    bitonic_network<N, std::uint64_t>(data);
+}
+
+/**
+ * @brief Sort at most @ref sorting_network_max_length elements with a sorting
+ * network.
+ *
+ * Elements are usually a key packed together with its index (see
+ * @ref packed_sort), so the network sorts keys and indexes together. The
+ * input is padded with the largest possible element to the next power of two
+ * (at least 8) and sorted with AVX-512, AVX2 or scalar code, depending on what
+ * the CPU supports.
+ */
+inline void sort_network(std::uint64_t * data,
+                         std::size_t length,
+                         network_isa isa = detected_network_isa())
+{
+    alignas(64) std::uint64_t buffer[sorting_network_max_length];
+    std::copy(data, data + length, buffer);
+
+    std::size_t padded = 8;
+    while (padded < length)
+        padded *= 2;
+    std::fill(buffer + length, buffer + padded,
+              std::numeric_limits<std::uint64_t>::max());
+
+    switch (padded)
+    {
+    case 8:
+        bitonic_network_dispatch<8>(buffer, isa);
+        break;
+    case 16:
+        bitonic_network_dispatch<16>(buffer, isa);
+        break;
+    case 32:
+        bitonic_network_dispatch<32>(buffer, isa);
+        break;
+    default:
+        bitonic_network_dispatch<64>(buffer, isa);
+        break;
+    }
+
+    std::copy(buffer, buffer + length, data);
+}
+
+/**
+ * @brief Merge sorted `[first, middle)` and `[middle, last)` into `output`
+ * without data dependent branches.
+ */
+inline void branchless_merge(const std::uint64_t * first,
+                             const std::uint64_t * middle,
+                             const std::uint64_t * last,
+                             std::uint64_t * output)
+{
+    const std::uint64_t * left = first;
+    const std::uint64_t * right = middle;
+
+    while (left != middle && right != last)
+    {
+        bool take_right = *right < *left;
+        *output++ = take_right ? *right : *left;
+        right += take_right;
+        left += !take_right;
+    }
+
+    output = std::copy(left, middle, output);
+    std::copy(right, last, output);
+}
+
+/**
+ * @brief Sort `length` elements of `data` by sorting blocks of
+ * @ref sorting_network_max_length elements with @ref sort_network and merging
+ * them bottom-up through `buffer`, which must have room for `length` elements.
+ */
+inline void network_merge_sort(std::uint64_t * data,
+                               std::uint64_t * buffer,
+                               std::size_t length)
+{
+    constexpr std::size_t block = sorting_network_max_length;
+
+    network_isa isa = detected_network_isa();
+    for (std::size_t i = 0; i < length; i += block)
+        sort_network(data + i, std::min(block, length - i), isa);
+
+    std::uint64_t * from = data;
+    std::uint64_t * to = buffer;
+    for (std::size_t width = block; width < length; width *= 2)
+    {
+        for (std::size_t i = 0; i < length; i += 2 * width)
+        {
+            std::size_t middle = std::min(i + width, length);
+            std::size_t last = std::min(i + 2 * width, length);
+            branchless_merge(from + i, from + middle, from + last, to + i);
+        }
+        std::swap(from, to);
+    }
+
+    if (from != data)
+        std::copy(from, from + length, data);
+}
+};  // namespace detail
+};  // namespace indexsort
+
+#endif
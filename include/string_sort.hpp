@@ -0,0 +1,311 @@
+#ifndef STRING_SORT_
+#define STRING_SORT_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "apply_permutation.hpp"
+#include "base.hpp"
+#include "instrumentation.hpp"
+#include "ordered_key.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Ranges of at most this many strings are sorted by comparisons.
+ */
+constexpr std::ptrdiff_t string_sort_small_range = 32;
+
+/**
+ * @brief Bytes of a string cached in every @ref string_entry.
+ */
+constexpr std::size_t string_prefix_length = sizeof(std::uint64_t);
+
+/**
+ * @brief Position of a string together with 8 bytes of it starting at the
+ * current depth of the sort.
+ */
+template <typename Index>
+struct string_entry
+{
+    std::uint64_t prefix;
+    Index index;
+};
+
+/**
+ * @brief Bytes `[depth, depth + 8)` of `s` as a big endian integer, so that
+ * integers compare like the bytes. Missing bytes are zero.
+ *
+ * The bits are flipped for a descending sort.
+ */
+template <bool Descending>
+std::uint64_t load_prefix(std::string_view s, std::size_t depth)
+{
+    unsigned char bytes[string_prefix_length] = {};
+    std::size_t count = std::min(string_prefix_length, s.size() - depth);
+    if (count > 0)
+        std::memcpy(bytes, s.data() + depth, count);
+
+    std::uint64_t prefix = 0;
+    for (unsigned char byte : bytes)
+        prefix = (prefix << 8) | byte;
+
+    return Descending ? ~prefix : prefix;
+}
+
+/**
+ * @brief Sort entries whose strings share their first `depth` bytes by
+ * comparing the cached prefixes and, on ties, the rest of the strings.
+ */
+template <bool Stable, bool Descending, typename Entry, typename View>
+void compare_sort_strings(Entry * first,
+                          Entry * last,
+                          std::size_t depth,
+                          const View & view)
+{
+    std::sort(first, last,
+              [depth, &view](const Entry & a, const Entry & b)
+              {
+                  if (a.prefix != b.prefix)
+                      return a.prefix < b.prefix;
+
+                  int order =
+                    view(a.index).substr(depth).compare(view(b.index).substr(
+                      depth));
+                  if (order != 0)
+                      return Descending ? order > 0 : order < 0;
+
+                  return Stable && a.index < b.index;
+              });
+}
+
+/**
+ * @brief Split entries with equal prefixes at `depth` into strings which end
+ * within the prefix and strings which continue after it.
+ *
+ * Strings which end within the prefix are sorted by their length, because the
+ * shorter of two such strings is a prefix of the longer one. They go before
+ * the other strings, or after them for a descending sort. The prefixes of the
+ * other strings are reloaded at `depth + 8`.
+ *
+ * @return The range of strings which continue after the prefix.
+ */
+template <bool Stable, bool Descending, typename Entry, typename View>
+std::pair<Entry *, Entry *> split_finished_strings(Entry * first,
+                                                   Entry * last,
+                                                   std::size_t depth,
+                                                   const View & view)
+{
+    std::size_t next_depth = depth + string_prefix_length;
+
+    Entry * middle = first;
+    for (Entry * entry = first; entry != last; ++entry)
+    {
+        std::string_view s = view(entry->index);
+        bool finished = s.size() <= next_depth;
+        if (!finished)
+            entry->prefix = load_prefix<Descending>(s, next_depth);
+        if (finished != Descending)
+            std::swap(*entry, *middle++);
+    }
+
+    Entry * finished_first = Descending ? middle : first;
+    Entry * finished_last = Descending ? last : middle;
+
+    std::sort(finished_first, finished_last,
+              [&view](const Entry & a, const Entry & b)
+              {
+                  auto a_size = view(a.index).size();
+                  auto b_size = view(b.index).size();
+                  if (a_size != b_size)
+                      return Descending ? a_size > b_size : a_size < b_size;
+                  return Stable && a.index < b.index;
+              });
+
+    return Descending ? std::pair(first, middle) : std::pair(middle, last);
+}
+
+/**
+ * @brief Multikey quicksort of entries whose strings share their first
+ * `depth` bytes, with 8 cached bytes as the key character.
+ *
+ * Entries are partitioned three ways by their cached prefixes. Entries with
+ * smaller and greater prefixes are sorted recursively at the same depth. The
+ * strings of entries with equal prefixes are only read to load their next
+ * prefix, so most of the work touches the entries alone instead of chasing a
+ * pointer to the string for every comparison. Like introsort, a range that
+ * partitions badly too often is sorted by comparisons instead.
+ */
+template <bool Stable, bool Descending, typename Entry, typename View>
+void multikey_quicksort(Entry * first,
+                        Entry * last,
+                        std::size_t depth,
+                        int budget,
+                        const View & view)
+{
+    while (last - first > string_sort_small_range)
+    {
+        if (budget-- == 0)
+            break;
+
+        std::uint64_t a = first->prefix;
+        std::uint64_t b = first[(last - first) / 2].prefix;
+        std::uint64_t c = last[-1].prefix;
+        std::uint64_t pivot =
+          std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        Entry * lt = first;
+        Entry * gt = last;
+        for (Entry * i = first; i < gt;)
+        {
+            if (i->prefix < pivot)
+                std::swap(*lt++, *i++);
+            else if (pivot < i->prefix)
+                std::swap(*i, *--gt);
+            else
+                ++i;
+        }
+
+        multikey_quicksort<Stable, Descending>(first, lt, depth, budget, view);
+        multikey_quicksort<Stable, Descending>(gt, last, depth, budget, view);
+
+        if (gt - lt < 2)
+            return;
+
+        std::tie(first, last) =
+          split_finished_strings<Stable, Descending>(lt, gt, depth, view);
+        depth += string_prefix_length;
+
+        budget = 0;
+        for (auto length = last - first; length > 1; length /= 2)
+            budget += 2;
+    }
+
+    compare_sort_strings<Stable, Descending>(first, last, depth, view);
+}
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void string_sort_impl(RandomIt1 value_begin,
+                      RandomIt1 value_end,
+                      RandomIt2 index_begin,
+                      RandomIt2 index_end,
+                      [[maybe_unused]] Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using direction = compare_direction<Compare, value_val_type>;
+
+    static_assert(
+      std::is_convertible_v<const value_val_type &, std::string_view> &&
+        direction::supported,
+      "string_sort() requires values convertible to std::string_view "
+      "compared by std::less or std::greater.");
+
+    constexpr bool descending = direction::descending;
+    using entry = string_entry<index_val_type>;
+
+    auto view = [value_begin](index_val_type i)
+    { return std::string_view(value_begin[i]); };
+
+    std::vector<entry> entries;
+    entries.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(entry));
+
+    {
+        INDEXSORT_PHASE("sort");
+
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i, ++n)
+            entries.push_back({load_prefix<descending>(view(n), 0), n});
+
+        int budget = 0;
+        for (auto remaining = length; remaining > 1; remaining /= 2)
+            budget += 2;
+
+        multikey_quicksort<Stable, descending>(
+          entries.data(), entries.data() + length, 0, budget, view);
+    }
+
+    using value_diff_type =
+      typename std::iterator_traits<RandomIt1>::difference_type;
+
+    INDEXSORT_PHASE("apply");
+    for (value_diff_type i = 0; i < length; ++i)
+        index_begin[i] = entries[i].index;
+
+    indexsort::apply_permutation(value_begin, value_end, index_begin,
+                                 index_end);
+}
+};  // namespace detail
+
+/**
+ * Index sort specialized for strings, for example `std::string` or
+ * `std::string_view`.
+ *
+ * Sorting an index of strings by comparisons reads both strings through a
+ * pointer for every comparison. This algorithm instead keeps the next 8 bytes
+ * of every string cached in a small entry next to its position and sorts the
+ * entries by multikey quicksort, treating the 8 bytes as one character.
+ * Strings are only read again when their cached bytes are equal, to load the
+ * following 8 bytes, and in small ranges, which are sorted by comparisons on
+ * the cached bytes with full comparisons only on ties. Strings with long
+ * common prefixes, like paths or log lines, are therefore compared 8 bytes at
+ * a time. The permutation is then applied to the values like in
+ * @ref cycle_apply_sort.
+ *
+ * Strings are ordered byte by byte as unsigned chars, like
+ * `std::string::compare`. `cmp` is never called, its type is only used to
+ * determine the direction of the sort, so it must be `std::less` or
+ * `std::greater`. Like @ref vector_pair_sort, this algorithm doesn't read the
+ * contents of the index iterable.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void string_sort(RandomIt1 value_begin,
+                 RandomIt1 value_end,
+                 RandomIt2 index_begin,
+                 RandomIt2 index_end,
+                 Compare cmp)
+{
+    detail::string_sort_impl<false>(value_begin, value_end, index_begin,
+                                    index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref string_sort.
+ *
+ * Entries of equal strings are ordered by their original position, so equal
+ * values keep their original relative order in the permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_string_sort(RandomIt1 value_begin,
+                        RandomIt1 value_end,
+                        RandomIt2 index_begin,
+                        RandomIt2 index_end,
+                        Compare cmp)
+{
+    detail::string_sort_impl<true>(value_begin, value_end, index_begin,
+                                   index_end, cmp);
+}
+};  // namespace indexsort
+
+#endif
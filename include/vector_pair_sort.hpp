@@ -2,75 +2,278 @@
 #define VECTOR_PAIR_SORT_
 
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "base.hpp"
+#include "instrumentation.hpp"
+#include "narrow_index.hpp"
 
 /**
  * @brief Namespace containing all implementations of sort that return the
  * permutation index.
  *
- * All functions in this namespace have the same signature.
- * `std::distance(value_begin, value_end)` and `std::distance(index_begin,
- * index_end)` must be equal. If not, @ref indexsort::length_mismatch_error will
- * be thrown. The index iterable **must** be initialized with a sequence
- * starting from 0 and continuing to `std::distance(value_begin, value_end) -
- * 1`.
+ * Unless documented otherwise, all functions in this namespace have the same
+ * signature. `std::distance(value_begin, value_end)` and
+ * `std::distance(index_begin, index_end)` must be equal. If not,
+ * @ref indexsort::length_mismatch_error will be thrown. The index iterable
+ * **must** be initialized with a sequence starting from 0 and continuing to
+ * `std::distance(value_begin, value_end) - 1`.
  *
  * Instance of the `Compare` type is passed to `std::sort`, so `Compare` must
  * fulfill requirements imposed by `std::sort`s `Compare`.
  */
 namespace indexsort
 {
+namespace detail
+{
 /**
- * Convert values into `std::vector` of `std::pair` containing the value and
- * it's index. Value is copied into the new vector. Then `std::sort` this vector
- * with a custom comparator that invokes `cmp()` on the values of pairs. The
- * result is then reconstructed from the sorted vector.
+ * @brief Sort values as a vector of `Pair`s of the value and its index.
  *
- * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
- * value_end) != std::distance(index_begin, index_end)`.
+ * `Pair` is either `std::pair` or @ref packed_pair with an index type that can
+ * hold every position.
  */
-template <typename RandomIt1, typename RandomIt2, typename Compare>
-void vector_pair_sort(RandomIt1 value_begin,
+template <typename Pair,
+          bool Stable,
+          typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void sort_index_pairs(RandomIt1 value_begin,
                       RandomIt1 value_end,
                       RandomIt2 index_begin,
-                      RandomIt2 index_end,
-                      Compare cmp)
+                      Compare cmp,
+                      const Allocator & alloc)
 {
     auto length = std::distance(value_begin, value_end);
 
-    if (length != std::distance(index_begin, index_end))
-        throw length_mismatch_error("Length of both iterables must match!");
-
-    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
-    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using pair_index_type = decltype(Pair::second);
+    using pair_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Pair>;
 
-    std::vector<std::pair<value_val_type, index_val_type>> conversion;
+    std::vector<Pair, pair_allocator> conversion{pair_allocator(alloc)};
     conversion.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(Pair));
 
-    // n is the index. We don't use index_begin because calculating this is
-    // simpler. This also means that vector_pair_sort() could be fed garbage in
-    // index_begin and it would still work.
-    index_val_type n = 0;
-    for (RandomIt1 i(value_begin); i != value_end; ++i)
-        conversion.emplace_back(*i, n++);
+    {
+        INDEXSORT_PHASE("convert");
 
-    using pair_type = std::pair<value_val_type, index_val_type>;
-    std::sort(conversion.begin(), conversion.end(),
-              [&cmp](const pair_type & a, const pair_type & b)
-              { return cmp(a.first, b.first); });
+        // n is the index. We don't use index_begin because calculating this
+        // is simpler. This also means that vector_pair_sort() could be fed
+        // garbage in index_begin and it would still work.
+        pair_index_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+            conversion.emplace_back(std::move(*i), n++);
+    }
 
+    {
+        INDEXSORT_PHASE("sort");
+        detail::sort<Stable>(conversion.begin(), conversion.end(),
+                             [&cmp](const Pair & a, const Pair & b)
+                             { return cmp(pair_value(a), pair_value(b)); });
+    }
+
+    INDEXSORT_PHASE("apply");
     using value_diff_type =
       typename std::iterator_traits<RandomIt1>::difference_type;
 
     for (value_diff_type i = 0; i < length; ++i)
     {
-        value_begin[i] = conversion[i].first;
+        value_begin[i] = take_pair_value(conversion[i]);
         index_begin[i] = conversion[i].second;
     }
 }
+
+template <bool Stable,
+          typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void vector_pair_sort_impl(RandomIt1 value_begin,
+                           RandomIt1 value_end,
+                           RandomIt2 index_begin,
+                           RandomIt2 index_end,
+                           Compare cmp,
+                           const Allocator & alloc)
+{
+    if (std::distance(value_begin, value_end) !=
+        std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    sort_index_pairs<std::pair<value_val_type, index_val_type>, Stable>(
+      value_begin, value_end, index_begin, cmp, alloc);
+}
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void narrow_vector_pair_sort_impl(RandomIt1 value_begin,
+                                  RandomIt1 value_end,
+                                  RandomIt2 index_begin,
+                                  RandomIt2 index_end,
+                                  Compare cmp)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    with_narrow_index<std::make_unsigned_t<index_val_type>>(
+      static_cast<std::size_t>(length),
+      [&](auto narrow)
+      {
+          using pair_type = index_pair_t<value_val_type, decltype(narrow)>;
+
+          sort_index_pairs<pair_type, Stable>(value_begin, value_end,
+                                              index_begin, cmp,
+                                              std::allocator<char>());
+      });
+}
+};  // namespace detail
+
+/**
+ * Convert values into `std::vector` of `std::pair` containing the value and
+ * it's index. Value is moved into the new vector. Then `std::sort` this vector
+ * with a custom comparator that invokes `cmp()` on the values of pairs. The
+ * result is then moved back from the sorted vector.
+ *
+ * Values are never copied, so types like `std::string` are sorted without deep
+ * copies and move-only types are supported.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void vector_pair_sort(RandomIt1 value_begin,
+                      RandomIt1 value_end,
+                      RandomIt2 index_begin,
+                      RandomIt2 index_end,
+                      Compare cmp)
+{
+    detail::vector_pair_sort_impl<false>(value_begin, value_end, index_begin,
+                                         index_end, cmp,
+                                         std::allocator<char>());
+}
+
+/**
+ * @brief @ref vector_pair_sort which allocates its temporary buffer with
+ * `alloc`.
+ *
+ * Passing an @ref arena_allocator makes repeated calls reuse the same memory
+ * instead of allocating a new buffer every time.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void vector_pair_sort(RandomIt1 value_begin,
+                      RandomIt1 value_end,
+                      RandomIt2 index_begin,
+                      RandomIt2 index_end,
+                      Compare cmp,
+                      const Allocator & alloc)
+{
+    detail::vector_pair_sort_impl<false>(value_begin, value_end, index_begin,
+                                         index_end, cmp, alloc);
+}
+
+/**
+ * @brief Stable variation of @ref vector_pair_sort.
+ *
+ * This algorithm uses `std::stable_sort` instead of `std::sort`, so equal
+ * values keep their original relative order in the permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_vector_pair_sort(RandomIt1 value_begin,
+                             RandomIt1 value_end,
+                             RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             Compare cmp)
+{
+    detail::vector_pair_sort_impl<true>(value_begin, value_end, index_begin,
+                                        index_end, cmp, std::allocator<char>());
+}
+
+/**
+ * @brief @ref stable_vector_pair_sort which allocates its temporary buffer with
+ * `alloc`.
+ *
+ * Only the buffer of pairs is allocated with `alloc`. `std::stable_sort` still
+ * allocates its own merge buffer on every call, so an @ref arena_allocator
+ * saves one allocation per call, not all of them.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void stable_vector_pair_sort(RandomIt1 value_begin,
+                             RandomIt1 value_end,
+                             RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             Compare cmp,
+                             const Allocator & alloc)
+{
+    detail::vector_pair_sort_impl<true>(value_begin, value_end, index_begin,
+                                        index_end, cmp, alloc);
+}
+
+/**
+ * @brief @ref vector_pair_sort which stores the narrowest index type that can
+ * hold every position in the pairs.
+ *
+ * Inputs shorter than 2^16 values use 16-bit indexes and inputs shorter than
+ * 2^32 values use 32-bit indexes. They are widened only when they are written
+ * to `index_begin`. Arithmetic values are stored in pairs without padding, so
+ * a `double` with a 32-bit index takes 12 bytes instead of the 16 bytes of
+ * `std::pair<double, std::uint64_t>`. Less memory is moved by every step of
+ * the sort.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void narrow_vector_pair_sort(RandomIt1 value_begin,
+                             RandomIt1 value_end,
+                             RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             Compare cmp)
+{
+    detail::narrow_vector_pair_sort_impl<false>(value_begin, value_end,
+                                                index_begin, index_end, cmp);
+}
+
+/**
+ * @brief Stable variation of @ref narrow_vector_pair_sort.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_narrow_vector_pair_sort(RandomIt1 value_begin,
+                                    RandomIt1 value_end,
+                                    RandomIt2 index_begin,
+                                    RandomIt2 index_end,
+                                    Compare cmp)
+{
+    detail::narrow_vector_pair_sort_impl<true>(value_begin, value_end,
+                                               index_begin, index_end, cmp);
+}
 };  // namespace indexsort
 
 #endif
@@ -2,13 +2,74 @@
 #define VECTOR_PAIR_SORT2_
 
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "base.hpp"
+#include "instrumentation.hpp"
 
 namespace indexsort
 {
+namespace detail
+{
+template <bool Stable,
+          typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void vector_pair_sort2_impl(RandomIt1 value_begin,
+                            RandomIt1 value_end,
+                            RandomIt2 index_begin,
+                            RandomIt2 index_end,
+                            Compare cmp,
+                            const Allocator & alloc)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+
+    using pair_type = std::pair<value_val_type, index_val_type>;
+    using pair_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<pair_type>;
+
+    std::vector<pair_type, pair_allocator> conversion{pair_allocator(alloc)};
+    conversion.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * sizeof(pair_type));
+
+    {
+        INDEXSORT_PHASE("convert");
+
+        // n is the index. We don't use index_begin because calculating this
+        // is simpler. This also means that vector_pair_sort() could be fed
+        // garbage in index_begin and it would still work.
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+            conversion.emplace_back(std::move(*i), n++);
+    }
+
+    {
+        INDEXSORT_PHASE("sort");
+        detail::sort<Stable>(conversion.begin(), conversion.end(),
+                             [&cmp](const pair_type & a, const pair_type & b)
+                             { return cmp(a.first, b.first); });
+    }
+
+    INDEXSORT_PHASE("apply");
+    for (auto vector_iter(conversion.begin()); vector_iter != conversion.end();
+         ++vector_iter, ++value_begin, ++index_begin)
+    {
+        *value_begin = std::move(vector_iter->first);
+        *index_begin = vector_iter->second;
+    }
+}
+};  // namespace detail
+
 /**
  * @brief Variation of @ref vector_pair_sort.
  * This version of @ref vector_pair_sort uses iterators when copying values and
@@ -25,35 +86,81 @@ void vector_pair_sort2(RandomIt1 value_begin,
                        RandomIt2 index_end,
                        Compare cmp)
 {
-    auto length = std::distance(value_begin, value_end);
-
-    if (length != std::distance(index_begin, index_end))
-        throw length_mismatch_error("Length of both iterables must match!");
-
-    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
-    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
-
-    std::vector<std::pair<value_val_type, index_val_type>> conversion;
-    conversion.reserve(length);
+    detail::vector_pair_sort2_impl<false>(value_begin, value_end, index_begin,
+                                          index_end, cmp,
+                                          std::allocator<char>());
+}
 
-    // n is the index. We don't use index_begin because calculating this is
-    // simpler. This also means that vector_pair_sort() could be fed garbage in
-    // index_begin and it would still work.
-    index_val_type n = 0;
-    for (RandomIt1 i(value_begin); i != value_end; ++i)
-        conversion.emplace_back(*i, n++);
+/**
+ * @brief @ref vector_pair_sort2 which allocates its temporary buffer with
+ * `alloc`.
+ *
+ * Passing an @ref arena_allocator makes repeated calls reuse the same memory
+ * instead of allocating a new buffer every time.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void vector_pair_sort2(RandomIt1 value_begin,
+                       RandomIt1 value_end,
+                       RandomIt2 index_begin,
+                       RandomIt2 index_end,
+                       Compare cmp,
+                       const Allocator & alloc)
+{
+    detail::vector_pair_sort2_impl<false>(value_begin, value_end, index_begin,
+                                          index_end, cmp, alloc);
+}
 
-    using pair_type = std::pair<value_val_type, index_val_type>;
-    std::sort(conversion.begin(), conversion.end(),
-              [&cmp](const pair_type & a, const pair_type & b)
-              { return cmp(a.first, b.first); });
+/**
+ * @brief Stable variation of @ref vector_pair_sort2.
+ *
+ * This algorithm uses `std::stable_sort` instead of `std::sort`, so equal
+ * values keep their original relative order in the permutation index.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_vector_pair_sort2(RandomIt1 value_begin,
+                              RandomIt1 value_end,
+                              RandomIt2 index_begin,
+                              RandomIt2 index_end,
+                              Compare cmp)
+{
+    detail::vector_pair_sort2_impl<true>(value_begin, value_end, index_begin,
+                                         index_end, cmp,
+                                         std::allocator<char>());
+}
 
-    for (auto vector_iter(conversion.begin()); vector_iter != conversion.end();
-         ++vector_iter, ++value_begin, ++index_begin)
-    {
-        *value_begin = vector_iter->first;
-        *index_begin = vector_iter->second;
-    }
+/**
+ * @brief @ref stable_vector_pair_sort2 which allocates its temporary buffer
+ * with `alloc`.
+ *
+ * Only the buffer of pairs is allocated with `alloc`. `std::stable_sort` still
+ * allocates its own merge buffer on every call, so an @ref arena_allocator
+ * saves one allocation per call, not all of them.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1,
+          typename RandomIt2,
+          typename Compare,
+          typename Allocator>
+void stable_vector_pair_sort2(RandomIt1 value_begin,
+                              RandomIt1 value_end,
+                              RandomIt2 index_begin,
+                              RandomIt2 index_end,
+                              Compare cmp,
+                              const Allocator & alloc)
+{
+    detail::vector_pair_sort2_impl<true>(value_begin, value_end, index_begin,
+                                         index_end, cmp, alloc);
 }
 };  // namespace indexsort
 
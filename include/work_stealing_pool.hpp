@@ -0,0 +1,423 @@
+#ifndef WORK_STEALING_POOL_
+#define WORK_STEALING_POOL_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Size of a cache line, used to keep data written by different threads
+ * on different cache lines.
+ */
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * @brief Task which can be pushed to a @ref work_stealing_deque.
+ */
+struct pool_task
+{
+    virtual ~pool_task() = default;
+    virtual void execute() = 0;
+};
+
+template <typename Function>
+struct pool_function_task : pool_task
+{
+    explicit pool_function_task(Function function)
+      : function(std::move(function))
+    {
+    }
+
+    void execute() override
+    {
+        function();
+    }
+
+    Function function;
+};
+
+/**
+ * @brief Lock-free Chase-Lev deque of tasks.
+ *
+ * The owning thread pushes and pops tasks at the bottom, other threads steal
+ * tasks from the top. The only contended operation is a compare and swap on
+ * the top index, which is needed when a thief steals a task or when the owner
+ * pops the last task. The ring buffer grows when it is full. Old buffers may
+ * still be read by thieves, so they are kept until the deque is destroyed.
+ *
+ * The memory orderings are based on "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" by Lê, Pop, Cohen and Zappa Nardelli.
+ */
+class work_stealing_deque
+{
+public:
+    work_stealing_deque() : ring_(new ring(initial_capacity))
+    {
+        rings_.emplace_back(ring_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Push a task to the bottom. Only the owner may call this.
+     */
+    void push(pool_task * task)
+    {
+        std::ptrdiff_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::ptrdiff_t top = top_.load(std::memory_order_acquire);
+        ring * tasks = ring_.load(std::memory_order_relaxed);
+
+        if (bottom - top >= tasks->capacity)
+        {
+            rings_.emplace_back(tasks->grow(top, bottom));
+            tasks = rings_.back().get();
+            ring_.store(tasks, std::memory_order_release);
+        }
+
+        // Publishes the task to thieves, which load bottom_ with acquire.
+        tasks->put(bottom, task);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Pop the task pushed last. Only the owner may call this.
+     *
+     * @return The task, or `nullptr` if the deque is empty.
+     */
+    pool_task * pop()
+    {
+        std::ptrdiff_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        ring * tasks = ring_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::ptrdiff_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        pool_task * task = tasks->get(bottom);
+        if (top == bottom)
+        {
+            // The last task, thieves may race for it.
+            if (!top_.compare_exchange_strong(top, top + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+                task = nullptr;
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return task;
+    }
+
+    /**
+     * @brief Steal the oldest task. Any thread may call this.
+     *
+     * @return The task, or `nullptr` if the deque is empty or another thread
+     * took the task first.
+     */
+    pool_task * steal()
+    {
+        std::ptrdiff_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::ptrdiff_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return nullptr;
+
+        pool_task * task = ring_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+
+        return task;
+    }
+
+private:
+    static constexpr std::ptrdiff_t initial_capacity = 256;
+
+    struct ring
+    {
+        explicit ring(std::ptrdiff_t capacity)
+          : capacity(capacity), tasks(new std::atomic<pool_task *>[capacity])
+        {
+        }
+
+        pool_task * get(std::ptrdiff_t i) const
+        {
+            return tasks[i & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(std::ptrdiff_t i, pool_task * task)
+        {
+            tasks[i & (capacity - 1)].store(task, std::memory_order_relaxed);
+        }
+
+        ring * grow(std::ptrdiff_t top, std::ptrdiff_t bottom) const
+        {
+            auto bigger = new ring(capacity * 2);
+            for (std::ptrdiff_t i = top; i < bottom; ++i)
+                bigger->put(i, get(i));
+            return bigger;
+        }
+
+        std::ptrdiff_t capacity;
+        std::unique_ptr<std::atomic<pool_task *>[]> tasks;
+    };
+
+    alignas(cache_line_size) std::atomic<std::ptrdiff_t> top_{0};
+    alignas(cache_line_size) std::atomic<std::ptrdiff_t> bottom_{0};
+    std::atomic<ring *> ring_;
+    std::vector<std::unique_ptr<ring>> rings_;
+};
+};  // namespace detail
+
+/**
+ * Pool of threads which run recursively spawned tasks by work stealing.
+ *
+ * Every thread, including the one calling @ref run, owns a
+ * @ref detail::work_stealing_deque. Tasks spawned by a task are pushed to the
+ * deque of the thread running it, which keeps working on its newest tasks.
+ * A thread without tasks steals the oldest task of a random other thread,
+ * which for recursive algorithms is the largest piece of work left. Uneven
+ * tasks, like the partitions of skewed values, therefore end up balanced
+ * without any locking.
+ *
+ * Threads are started once and wait on a condition variable between calls to
+ * @ref run, so a pool can be reused without paying for starting threads every
+ * time. While a call is running, idle threads keep trying to steal.
+ */
+class work_stealing_pool
+{
+public:
+    /**
+     * @param thread_count Number of threads, including the one calling
+     * @ref run. At least one is used.
+     */
+    explicit work_stealing_pool(
+      unsigned thread_count = std::thread::hardware_concurrency())
+      : deques_(std::max(1u, thread_count))
+    {
+        threads_.reserve(deques_.size() - 1);
+        try
+        {
+            for (unsigned worker = 1; worker < deques_.size(); ++worker)
+                threads_.emplace_back([this, worker]
+                                      { wait_for_work(worker); });
+        }
+        catch (...)
+        {
+            // The destructor isn't called if the constructor throws.
+            stop();
+            throw;
+        }
+    }
+
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool & operator=(const work_stealing_pool &) = delete;
+
+    ~work_stealing_pool()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Number of threads, including the one calling @ref run.
+     */
+    unsigned thread_count() const
+    {
+        return static_cast<unsigned>(deques_.size());
+    }
+
+    /**
+     * @brief Call `task()` and every task it spawns, directly or indirectly,
+     * and return when all of them have finished.
+     *
+     * The calling thread runs tasks too. Concurrent calls are run one after
+     * another. A task must not call `run` of the pool running it.
+     *
+     * If any task throws, the remaining tasks are still run and the first
+     * exception is rethrown.
+     */
+    template <typename Task>
+    void run(Task task)
+    {
+        std::lock_guard<std::mutex> lock(run_mutex_);
+
+        worker_identity caller = current_;
+        current_ = {this, 0};
+
+        pending_.store(1, std::memory_order_relaxed);
+        deques_[0].push(new detail::pool_function_task<Task>(std::move(task)));
+
+        {
+            std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        work(0);
+        current_ = caller;
+
+        std::exception_ptr exception = std::exchange(exception_, nullptr);
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+    /**
+     * @brief Add a task to the current call of @ref run. It may be run by any
+     * thread of the pool.
+     *
+     * Must only be called by tasks running in this pool.
+     */
+    template <typename Task>
+    void spawn(Task task)
+    {
+        assert(current_.pool == this);
+
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        deques_[current_.worker].push(
+          new detail::pool_function_task<Task>(std::move(task)));
+    }
+
+private:
+    struct worker_identity
+    {
+        const work_stealing_pool * pool;
+        unsigned worker;
+    };
+
+    struct alignas(detail::cache_line_size) padded_deque
+      : detail::work_stealing_deque
+    {
+    };
+
+    /**
+     * @brief Wake up the threads started so far and wait until they exit.
+     */
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto & thread : threads_)
+            thread.join();
+    }
+
+    /**
+     * @brief Body of every thread except the one calling @ref run.
+     */
+    void wait_for_work(unsigned worker)
+    {
+        current_ = {this, worker};
+
+        std::uint64_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                wake_.wait(lock,
+                           [this, &seen]
+                           { return stopping_ || generation_ != seen; });
+                if (stopping_)
+                    return;
+                seen = generation_;
+            }
+
+            work(worker);
+        }
+    }
+
+    /**
+     * @brief Run own and stolen tasks until all tasks of the current call have
+     * finished.
+     */
+    void work(unsigned worker)
+    {
+        // xorshift, to pick victims in a different order on every thread.
+        std::uint32_t random = 2463534242u + worker;
+        unsigned thread_count = this->thread_count();
+
+        while (pending_.load(std::memory_order_acquire) != 0)
+        {
+            detail::pool_task * task = deques_[worker].pop();
+
+            if (task == nullptr && thread_count > 1)
+            {
+                random ^= random << 13;
+                random ^= random >> 17;
+                random ^= random << 5;
+
+                unsigned first_victim = random % thread_count;
+                for (unsigned i = 0; i < thread_count && task == nullptr; ++i)
+                {
+                    unsigned victim = (first_victim + i) % thread_count;
+                    if (victim != worker)
+                        task = deques_[victim].steal();
+                }
+            }
+
+            if (task == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            execute(task);
+        }
+    }
+
+    void execute(detail::pool_task * task)
+    {
+        try
+        {
+            task->execute();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(exception_mutex_);
+            if (!exception_)
+                exception_ = std::current_exception();
+        }
+
+        delete task;
+        pending_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    static inline thread_local worker_identity current_{nullptr, 0};
+
+    std::vector<padded_deque> deques_;
+    std::vector<std::thread> threads_;
+
+    alignas(detail::cache_line_size) std::atomic<std::size_t> pending_{0};
+
+    std::mutex run_mutex_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::uint64_t generation_ = 0;
+    bool stopping_ = false;
+
+    std::mutex exception_mutex_;
+    std::exception_ptr exception_;
+};
+};  // namespace indexsort
+
+#endif
@@ -0,0 +1,342 @@
+#ifndef WORK_STEALING_SORT_
+#define WORK_STEALING_SORT_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base.hpp"
+#include "few_unique_sort.hpp"
+#include "instrumentation.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace indexsort
+{
+namespace detail
+{
+/**
+ * @brief Ranges of at most this many values are sorted by a single task.
+ */
+constexpr std::ptrdiff_t work_stealing_task_length = 1 << 13;
+
+/**
+ * @brief Pool shared by every call of @ref work_stealing_sort without a pool,
+ * with a thread for every hardware thread. It is started by the first call.
+ */
+inline work_stealing_pool & default_work_stealing_pool()
+{
+    static work_stealing_pool pool;
+    return pool;
+}
+
+/**
+ * @brief Parallel quicksort of pairs by their values.
+ *
+ * Every partition step spawns a task for the values less than the pivot and
+ * continues with the values greater than it. Ranges are partitioned three
+ * ways, so runs of equal values, which are common in skewed distributions,
+ * are final after one step.
+ */
+template <typename Pair, typename Compare>
+void work_stealing_quicksort(work_stealing_pool & pool,
+                             Pair * first,
+                             Pair * last,
+                             int budget,
+                             Compare & cmp)
+{
+    auto pair_cmp = [&cmp](const Pair & a, const Pair & b)
+    { return cmp(a.first, b.first); };
+
+    // Like introsort, a range that partitions badly too often is sorted by
+    // std::sort instead.
+    while (last - first > work_stealing_task_length && budget-- > 0)
+    {
+        auto [lt, gt] = three_way_partition(first, last, cmp);
+
+        if (lt - first > work_stealing_task_length)
+            pool.spawn(
+              [&pool, first, lt = lt, budget, &cmp]
+              { work_stealing_quicksort(pool, first, lt, budget, cmp); });
+        else
+            std::sort(first, lt, pair_cmp);
+
+        first = gt;
+    }
+
+    std::sort(first, last, pair_cmp);
+}
+
+/**
+ * @brief Parallel merge sort of pairs by their values.
+ *
+ * The range is split in halves until they are short enough for a single task,
+ * which sorts its range by `std::stable_sort`. Nodes of the split are numbered
+ * like a binary heap. The task which finishes the second child of a node
+ * merges both halves through the buffer and continues with the parent, so no
+ * task ever waits for another one.
+ */
+template <typename Pair, typename Compare>
+class work_stealing_merge_sort
+{
+public:
+    work_stealing_merge_sort(work_stealing_pool & pool,
+                             Pair * values,
+                             std::ptrdiff_t length,
+                             Compare & cmp)
+      : pool_(pool), values_(values), buffer_(length), cmp_(cmp)
+    {
+        std::size_t node_count = 1;
+        for (auto leaf = length; leaf > work_stealing_task_length;
+             leaf = (leaf + 1) / 2)
+            node_count = node_count * 2 + 1;
+
+        nodes_.resize(node_count);
+        unfinished_ = std::make_unique<std::atomic<int>[]>(node_count);
+    }
+
+    /**
+     * @brief Sort node `node` spanning `[first, last)`.
+     */
+    void sort(std::size_t node, std::ptrdiff_t first, std::ptrdiff_t last)
+    {
+        while (last - first > work_stealing_task_length)
+        {
+            std::ptrdiff_t middle = first + (last - first) / 2;
+            nodes_[node] = {first, middle, last};
+            unfinished_[node].store(2, std::memory_order_relaxed);
+
+            pool_.spawn([this, node, first, middle]
+                        { sort(2 * node + 1, first, middle); });
+
+            node = 2 * node + 2;
+            first = middle;
+        }
+
+        std::stable_sort(values_ + first, values_ + last,
+                         [this](const Pair & a, const Pair & b)
+                         { return cmp_(a.first, b.first); });
+
+        finish(node);
+    }
+
+private:
+    struct node_range
+    {
+        std::ptrdiff_t first;
+        std::ptrdiff_t middle;
+        std::ptrdiff_t last;
+    };
+
+    /**
+     * @brief Merge the parents of a sorted node whose other children are
+     * sorted too.
+     */
+    void finish(std::size_t node)
+    {
+        while (node != 0)
+        {
+            node = (node - 1) / 2;
+            if (unfinished_[node].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+
+            auto [first, middle, last] = nodes_[node];
+            std::merge(std::make_move_iterator(values_ + first),
+                       std::make_move_iterator(values_ + middle),
+                       std::make_move_iterator(values_ + middle),
+                       std::make_move_iterator(values_ + last),
+                       buffer_.begin() + first,
+                       [this](const Pair & a, const Pair & b)
+                       { return cmp_(a.first, b.first); });
+            std::move(buffer_.begin() + first, buffer_.begin() + last,
+                      values_ + first);
+        }
+    }
+
+    work_stealing_pool & pool_;
+    Pair * values_;
+    std::vector<Pair> buffer_;
+    Compare & cmp_;
+    std::vector<node_range> nodes_;
+    std::unique_ptr<std::atomic<int>[]> unfinished_;
+};
+
+template <bool Stable, typename RandomIt1, typename RandomIt2, typename Compare>
+void work_stealing_sort_impl(RandomIt1 value_begin,
+                             RandomIt1 value_end,
+                             RandomIt2 index_begin,
+                             RandomIt2 index_end,
+                             Compare cmp,
+                             work_stealing_pool * pool)
+{
+    auto length = std::distance(value_begin, value_end);
+
+    if (length != std::distance(index_begin, index_end))
+        throw length_mismatch_error("Length of both iterables must match!");
+
+    using value_val_type = typename std::iterator_traits<RandomIt1>::value_type;
+    using index_val_type = typename std::iterator_traits<RandomIt2>::value_type;
+    using pair_type = std::pair<value_val_type, index_val_type>;
+
+    std::vector<pair_type> conversion;
+    conversion.reserve(length);
+    INDEXSORT_COUNT_SCRATCH(length * (Stable ? 2 : 1) * sizeof(pair_type));
+
+    {
+        INDEXSORT_PHASE("sort");
+
+        index_val_type n = 0;
+        for (RandomIt1 i(value_begin); i != value_end; ++i)
+            conversion.emplace_back(std::move(*i), n++);
+
+        if (length <= work_stealing_task_length)
+        {
+            // Not worth waking up the pool.
+            detail::sort<Stable>(
+              conversion.begin(), conversion.end(),
+              [&cmp](const pair_type & a, const pair_type & b)
+              { return cmp(a.first, b.first); });
+        }
+        else
+        {
+            if (pool == nullptr)
+                pool = &default_work_stealing_pool();
+
+            if constexpr (Stable)
+            {
+                work_stealing_merge_sort<pair_type, Compare> merge_sort(
+                  *pool, conversion.data(), length, cmp);
+                pool->run([&merge_sort, length]
+                          { merge_sort.sort(0, 0, length); });
+            }
+            else
+            {
+                int budget = 0;
+                for (auto remaining = length; remaining > 1; remaining /= 2)
+                    budget += 2;
+
+                pair_type * values = conversion.data();
+                pool->run(
+                  [pool, values, length, budget, &cmp]
+                  {
+                      work_stealing_quicksort(*pool, values, values + length,
+                                              budget, cmp);
+                  });
+            }
+        }
+    }
+
+    INDEXSORT_PHASE("apply");
+    for (decltype(length) i = 0; i < length; ++i)
+    {
+        value_begin[i] = std::move(conversion[i].first);
+        index_begin[i] = conversion[i].second;
+    }
+}
+};  // namespace detail
+
+/**
+ * Parallel index sort which balances its work by work stealing. Values are
+ * sorted as pairs of the value and its index like in @ref vector_pair_sort,
+ * by a quicksort which runs every partition it splits off as a task of a
+ * @ref work_stealing_pool.
+ *
+ * Unlike @ref parallel_sort, which splits the values into one chunk per
+ * thread up front, threads which run out of work take over parts of the
+ * remaining partitions. Skewed values, whose partitions have very different
+ * sizes, therefore keep all threads busy. Equal values are final after one
+ * three-way partition step.
+ *
+ * The threads of the pool are reused by every call. Inputs of at most 8192
+ * values are sorted on the calling thread alone.
+ *
+ * @param pool Pool whose threads sort the values.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void work_stealing_sort(RandomIt1 value_begin,
+                        RandomIt1 value_end,
+                        RandomIt2 index_begin,
+                        RandomIt2 index_end,
+                        Compare cmp,
+                        work_stealing_pool & pool)
+{
+    detail::work_stealing_sort_impl<false>(value_begin, value_end,
+                                           index_begin, index_end, cmp, &pool);
+}
+
+/**
+ * @brief @ref work_stealing_sort using a pool shared by all calls, with a
+ * thread for every hardware thread.
+ *
+ * Concurrent calls share the pool, so they are run one after another.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void work_stealing_sort(RandomIt1 value_begin,
+                        RandomIt1 value_end,
+                        RandomIt2 index_begin,
+                        RandomIt2 index_end,
+                        Compare cmp)
+{
+    detail::work_stealing_sort_impl<false>(value_begin, value_end,
+                                           index_begin, index_end, cmp,
+                                           nullptr);
+}
+
+/**
+ * @brief Stable variation of @ref work_stealing_sort.
+ *
+ * Quicksort isn't stable, so values are sorted by a merge sort instead. The
+ * values are split in halves which are sorted by `std::stable_sort` as tasks
+ * and merged by the task finishing last, so equal values keep their original
+ * relative order in the permutation index.
+ *
+ * The value type must be default constructible.
+ *
+ * @param pool Pool whose threads sort the values.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_work_stealing_sort(RandomIt1 value_begin,
+                               RandomIt1 value_end,
+                               RandomIt2 index_begin,
+                               RandomIt2 index_end,
+                               Compare cmp,
+                               work_stealing_pool & pool)
+{
+    detail::work_stealing_sort_impl<true>(value_begin, value_end, index_begin,
+                                          index_end, cmp, &pool);
+}
+
+/**
+ * @brief @ref stable_work_stealing_sort using a pool shared by all calls,
+ * with a thread for every hardware thread.
+ *
+ * Concurrent calls share the pool, so they are run one after another.
+ *
+ * @throws indexsort::length_mismatch_error If `std::distance(value_begin,
+ * value_end) != std::distance(index_begin, index_end)`.
+ */
+template <typename RandomIt1, typename RandomIt2, typename Compare>
+void stable_work_stealing_sort(RandomIt1 value_begin,
+                               RandomIt1 value_end,
+                               RandomIt2 index_begin,
+                               RandomIt2 index_end,
+                               Compare cmp)
+{
+    detail::work_stealing_sort_impl<true>(value_begin, value_end, index_begin,
+                                          index_end, cmp, nullptr);
+}
+};  // namespace indexsort
+
+#endif
@@ -3,15 +3,42 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <algorithm>
+#include <array>
 #include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include "adaptive_sort.hpp"
+#include "append_sort.hpp"
+#include "apply_permutation.hpp"
+#include "argsort.hpp"
+#include "benchmark_common.hpp"
 #include "boost_index_apply_sort.hpp"
 #include "boost_index_apply_sort2.hpp"
+#include "branchless_quick_sort.hpp"
+#include "cycle_apply_sort.hpp"
 #include "double_sort.hpp"
+#include "few_unique_sort.hpp"
+#include "mapped_file.hpp"
+#include "multi_key_sort.hpp"
+#include "packed_sort.hpp"
+#include "parallel_sort.hpp"
+#include "partial_sort.hpp"
 #include "permutate_in_place_sort.hpp"
+#include "radix_sort.hpp"
+#include "rank.hpp"
+#include "scratch_arena.hpp"
+#include "sort.hpp"
+#include "sorting_network.hpp"
+#include "string_sort.hpp"
+#include "temporary_file.hpp"
 #include "vector_pair_sort.hpp"
 #include "vector_pair_sort2.hpp"
+#include "work_stealing_pool.hpp"
+#include "work_stealing_sort.hpp"
 
 constexpr int length_of_values = 1'000'000;
+constexpr int length_of_large_values = 100'000;
 
 using namespace indexsort;
 
@@ -159,6 +186,85 @@ TEST_CASE("Benchmark sorting integers of all algorithms", "[!benchmark]")
                                              index.begin(), index.end(), cmp);
           });
     };
+
+    BENCHMARK_ADVANCED("radix sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return radix_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("parallel sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return parallel_sort(values.begin(), values.end(), index.begin(),
+                                   index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("packed sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return packed_sort(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("argsort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return argsort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("cycle apply sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return cycle_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("branchless quick sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return branchless_quick_sort(values.begin(), values.end(),
+                                           index.begin(), index.end(), cmp);
+          });
+    };
 }
 
 TEST_CASE("Benchmark sorting doubles of all algorithms", "[!benchmark]")
@@ -289,4 +395,1607 @@ TEST_CASE("Benchmark sorting doubles of all algorithms", "[!benchmark]")
                                              index.begin(), index.end(), cmp);
           });
     };
+
+    BENCHMARK_ADVANCED("radix sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return radix_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("parallel sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return parallel_sort(values.begin(), values.end(), index.begin(),
+                                   index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("packed sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return packed_sort(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("argsort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return argsort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("cycle apply sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return cycle_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("branchless quick sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return branchless_quick_sort(values.begin(), values.end(),
+                                           index.begin(), index.end(), cmp);
+          });
+    };
+}
+
+TEST_CASE("Benchmark scaling of parallel sort", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> values_orig(length_of_values);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    // Initialize values with random numbers.
+    std::generate(values_orig.begin(), values_orig.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    std::vector<int> index_orig(length_of_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto cmp = std::less<int>();
+
+    REQUIRE(values_orig.size() == length_of_values);
+    REQUIRE(index_orig.size() == length_of_values);
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Powers of two up to the number of hardware threads, and the number of
+    // hardware threads itself.
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    for (unsigned threads : thread_counts)
+    {
+        BENCHMARK_ADVANCED("parallel sort with " + std::to_string(threads) +
+                           " threads")
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto values(values_orig);
+            auto index(index_orig);
+
+            meter.measure(
+              [&values, &index, &cmp, threads]
+              {
+                  return parallel_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp,
+                                       threads);
+              });
+        };
+    }
+}
+
+TEST_CASE("Benchmark stable sorting of all algorithms", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> values_orig(length_of_values);
+
+    // Initialize values with random numbers from a small range, so that there
+    // are many equal values whose order stable algorithms have to preserve.
+    std::uniform_int_distribution<> distrib(0, 99);
+
+    std::generate(values_orig.begin(), values_orig.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    std::vector<int> index_orig(length_of_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto cmp = std::less<int>();
+
+    REQUIRE(values_orig.size() == length_of_values);
+    REQUIRE(index_orig.size() == length_of_values);
+
+    BENCHMARK_ADVANCED("vector pair sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return vector_pair_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable vector pair sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return stable_vector_pair_sort(values.begin(), values.end(),
+                                             index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("vector pair sort 2")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return vector_pair_sort2(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable vector pair sort 2")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return stable_vector_pair_sort2(values.begin(), values.end(),
+                                              index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("double sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return double_sort(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable double sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return stable_double_sort(values.begin(), values.end(),
+                                        index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("boost index apply sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return boost_index_apply_sort(values.begin(), values.end(),
+                                            index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable boost index apply sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return stable_boost_index_apply_sort(values.begin(), values.end(),
+                                                   index.begin(), index.end(),
+                                                   cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("boost index apply sort 2")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return boost_index_apply_sort2(values.begin(), values.end(),
+                                             index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable boost index apply sort 2")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return stable_boost_index_apply_sort2(values.begin(),
+                                                    values.end(), index.begin(),
+                                                    index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("permutate in place sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return permutate_in_place_sort(values.begin(), values.end(),
+                                             index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable permutate in place sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return stable_permutate_in_place_sort(values.begin(),
+                                                    values.end(), index.begin(),
+                                                    index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("parallel sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return parallel_sort(values.begin(), values.end(), index.begin(),
+                                   index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable parallel sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return stable_parallel_sort(values.begin(), values.end(),
+                                          index.begin(), index.end(), cmp);
+          });
+    };
+}
+
+TEST_CASE("Benchmark partial sorting", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> values_orig(length_of_values);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    // Initialize values with random numbers.
+    std::generate(values_orig.begin(), values_orig.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    std::vector<int> index_orig(length_of_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto cmp = std::less<int>();
+
+    REQUIRE(values_orig.size() == length_of_values);
+    REQUIRE(index_orig.size() == length_of_values);
+
+    BENCHMARK_ADVANCED("vector pair sort (full sort for comparison)")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return vector_pair_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    for (int k : {10, 100, 1'000, 10'000, 100'000})
+    {
+        BENCHMARK_ADVANCED("partial index sort with k = " + std::to_string(k))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto values(values_orig);
+            auto index(index_orig);
+
+            meter.measure(
+              [&values, &index, &cmp, k]
+              {
+                  return partial_index_sort(values.begin(), values.end(),
+                                            index.begin(), index.end(), k,
+                                            cmp);
+              });
+        };
+    }
+}
+
+TEST_CASE("Benchmark sorting strings of all algorithms", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Strings are long enough not to fit into the small string buffer, so
+    // every copy allocates.
+    std::uniform_int_distribution<> length_distrib(16, 48);
+    std::uniform_int_distribution<> char_distrib('a', 'z');
+
+    std::vector<std::string> values_orig(length_of_large_values);
+    for (auto & value : values_orig)
+    {
+        value.resize(length_distrib(gen));
+        for (auto & c : value)
+            c = static_cast<char>(char_distrib(gen));
+    }
+
+    std::vector<int> index_orig(length_of_large_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto cmp = std::less<std::string>();
+
+    REQUIRE(values_orig.size() == length_of_large_values);
+    REQUIRE(index_orig.size() == length_of_large_values);
+
+    BENCHMARK_ADVANCED(
+      "sort index by values (this isn't index sort but it's put here for "
+      "comparison)")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return sort_index_by_values(values.begin(), values.end(),
+                                          index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("argsort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return argsort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("vector pair sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return vector_pair_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("vector pair sort 2")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return vector_pair_sort2(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("double sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return double_sort(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("boost index apply sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return boost_index_apply_sort(values.begin(), values.end(),
+                                            index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("boost index apply sort 2")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return boost_index_apply_sort2(values.begin(), values.end(),
+                                             index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("permutate in place sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return permutate_in_place_sort(values.begin(), values.end(),
+                                             index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("cycle apply sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return cycle_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("parallel sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return parallel_sort(values.begin(), values.end(), index.begin(),
+                                   index.end(), cmp);
+          });
+    };
+}
+
+TEST_CASE("Benchmark sorting large structs", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<large_row> values_orig(length_of_large_values);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    // Initialize keys with random numbers.
+    for (auto & row : values_orig)
+        row.key = distrib(gen);
+
+    std::vector<int> index_orig(length_of_large_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto cmp = [](const large_row & a, const large_row & b)
+    { return a.key < b.key; };
+
+    REQUIRE(values_orig.size() == length_of_large_values);
+    REQUIRE(index_orig.size() == length_of_large_values);
+
+    BENCHMARK_ADVANCED(
+      "sort index by values (this isn't index sort but it's put here for "
+      "comparison)")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return sort_index_by_values(values.begin(), values.end(),
+                                          index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("argsort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return argsort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("vector pair sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return vector_pair_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("boost index apply sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return boost_index_apply_sort(values.begin(), values.end(),
+                                            index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("permutate in place sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return permutate_in_place_sort(values.begin(), values.end(),
+                                             index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("cycle apply sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return cycle_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+}
+
+TEST_CASE("Benchmark applying permutations", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> values_orig(length_of_values);
+    std::iota(values_orig.begin(), values_orig.end(), 0);
+
+    std::vector<int> index_orig(length_of_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    // Sorted index is the identity permutation.
+    SECTION("sorted permutation")
+    {
+    }
+    SECTION("reversed permutation")
+    {
+        std::reverse(index_orig.begin(), index_orig.end());
+    }
+    SECTION("random permutation")
+    {
+        std::shuffle(index_orig.begin(), index_orig.end(), gen);
+    }
+
+    REQUIRE(values_orig.size() == length_of_values);
+    REQUIRE(index_orig.size() == length_of_values);
+
+    BENCHMARK_ADVANCED("boost apply permutation (with index copy)")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        const auto & index(index_orig);
+
+        meter.measure(
+          [&values, &index]
+          {
+              std::vector<int> temp(index.begin(), index.end());
+              return boost::algorithm::apply_permutation(
+                values.begin(), values.end(), temp.begin(), temp.end());
+          });
+    };
+
+    BENCHMARK_ADVANCED("permutate in place")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        const auto & index(index_orig);
+
+        meter.measure(
+          [&values, &index]
+          {
+              return detail::permutate_in_place(values.begin(), index.begin(),
+                                                length_of_values);
+          });
+    };
+
+    BENCHMARK_ADVANCED("cycle apply permutation")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        const auto & index(index_orig);
+
+        meter.measure(
+          [&values, &index]
+          {
+              return apply_permutation(values.begin(), values.end(),
+                                       index.begin(), index.end());
+          });
+    };
+}
+
+TEST_CASE("Benchmark reusing scratch arena", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> values_orig(length_of_values);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    std::generate(values_orig.begin(), values_orig.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    std::vector<int> index_orig(length_of_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto cmp = std::less<int>();
+
+    // The arena is grown by the second run and reused by all following runs.
+    scratch_arena arena;
+    arena_allocator<int> alloc(arena);
+
+    REQUIRE(values_orig.size() == length_of_values);
+    REQUIRE(index_orig.size() == length_of_values);
+
+    BENCHMARK_ADVANCED("vector pair sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return vector_pair_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("vector pair sort with scratch arena")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp, &alloc]
+          {
+              return vector_pair_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp, alloc);
+          });
+    };
+
+    BENCHMARK_ADVANCED("boost index apply sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp]
+          {
+              return boost_index_apply_sort(values.begin(), values.end(),
+                                            index.begin(), index.end(), cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("boost index apply sort with scratch arena")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        auto index(index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp, &alloc]
+          {
+              return boost_index_apply_sort(values.begin(), values.end(),
+                                            index.begin(), index.end(), cmp,
+                                            alloc);
+          });
+    };
+}
+
+TEST_CASE("Benchmark dispatcher thresholds", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+    std::uniform_real_distribution<> real_distrib(-1e6, 1e6);
+
+    auto sort = [](auto... args) { indexsort::sort(args...); };
+    auto radix = [](auto... args) { radix_sort(args...); };
+    auto packed = [](auto... args) { packed_sort(args...); };
+    auto quick = [](auto... args) { branchless_quick_sort(args...); };
+    auto cycle_apply = [](auto... args) { cycle_apply_sort(args...); };
+    auto vector_pair = [](auto... args) { vector_pair_sort(args...); };
+
+    // Lengths around the thresholds of detail::dispatch_thresholds. sort()
+    // should be as fast as the fastest of the algorithms it chooses from.
+    for (int length : {256, 1024, 4096, 1 << 16, 1 << 22})
+    {
+        auto suffix = " with length " + std::to_string(length);
+
+        std::vector<int> ints(length);
+        for (auto & value : ints)
+            value = distrib(gen);
+
+        auto int_cmp = std::less<int>();
+        benchmark_algorithm("sort integers" + suffix, ints, int_cmp, sort);
+        benchmark_algorithm("radix sort integers" + suffix, ints, int_cmp,
+                            radix);
+        benchmark_algorithm("packed sort integers" + suffix, ints, int_cmp,
+                            packed);
+        benchmark_algorithm("branchless quick sort integers" + suffix, ints,
+                            int_cmp, quick);
+
+        std::vector<double> doubles(length);
+        for (auto & value : doubles)
+            value = real_distrib(gen);
+
+        auto double_cmp = std::less<double>();
+        benchmark_algorithm("sort doubles" + suffix, doubles, double_cmp,
+                            sort);
+        benchmark_algorithm("radix sort doubles" + suffix, doubles,
+                            double_cmp, radix);
+        benchmark_algorithm("packed sort doubles" + suffix, doubles,
+                            double_cmp, packed);
+        benchmark_algorithm("branchless quick sort doubles" + suffix, doubles,
+                            double_cmp, quick);
+
+        auto custom_cmp = [](int a, int b) { return a < b; };
+        benchmark_algorithm("sort integers with custom comparator" + suffix,
+                            ints, custom_cmp, sort);
+        benchmark_algorithm("cycle apply sort integers with custom "
+                            "comparator" + suffix,
+                            ints, custom_cmp, cycle_apply);
+        benchmark_algorithm("vector pair sort integers with custom "
+                            "comparator" + suffix,
+                            ints, custom_cmp, vector_pair);
+
+        // Large structs are limited in length to keep the memory use low.
+        if (length > length_of_large_values)
+            continue;
+
+        std::vector<large_row> rows(length);
+        for (auto & row : rows)
+            row.key = distrib(gen);
+
+        auto row_cmp = [](const large_row & a, const large_row & b)
+        { return a.key < b.key; };
+        benchmark_algorithm("sort large structs" + suffix, rows, row_cmp,
+                            sort);
+        benchmark_algorithm("cycle apply sort large structs" + suffix, rows,
+                            row_cmp, cycle_apply);
+        benchmark_algorithm("vector pair sort large structs" + suffix, rows,
+                            row_cmp, vector_pair);
+    }
+}
+
+TEST_CASE("Benchmark sorting network", "[!benchmark]")
+{
+    using namespace indexsort::detail;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937_64 gen(rng_seed);
+
+    // Packed key and index elements, sorted in blocks of the network size.
+    std::vector<std::uint64_t> values_orig(length_of_values);
+    for (auto & value : values_orig)
+        value = gen();
+
+    constexpr std::size_t block = sorting_network_max_length;
+
+    BENCHMARK_ADVANCED("std::sort blocks")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+
+        meter.measure(
+          [&values]
+          {
+              for (std::size_t i = 0; i < values.size(); i += block)
+                  std::sort(values.begin() + i, values.begin() + i + block);
+          });
+    };
+
+    std::vector<network_isa> isas = {network_isa::scalar};
+    if (detected_network_isa() >= network_isa::avx2)
+        isas.push_back(network_isa::avx2);
+    if (detected_network_isa() >= network_isa::avx512)
+        isas.push_back(network_isa::avx512);
+
+    for (network_isa isa : isas)
+    {
+        BENCHMARK_ADVANCED("sort network blocks with instruction set " +
+                           std::to_string(static_cast<int>(isa)))
+        (Catch::Benchmark::Chronometer meter)
+        {
+            auto values(values_orig);
+
+            meter.measure(
+              [&values, isa]
+              {
+                  for (std::size_t i = 0; i < values.size(); i += block)
+                      sort_network(values.data() + i, block, isa);
+              });
+        };
+    }
+
+    BENCHMARK_ADVANCED("std::sort")(Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+
+        meter.measure([&values]
+                      { std::sort(values.begin(), values.end()); });
+    };
+
+    BENCHMARK_ADVANCED("network merge sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        auto values(values_orig);
+        std::vector<std::uint64_t> buffer(values.size());
+
+        meter.measure(
+          [&values, &buffer]
+          {
+              network_merge_sort(values.data(), buffer.data(), values.size());
+          });
+    };
+}
+
+TEST_CASE("Benchmark sorting files", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> values_orig(length_of_values);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    std::generate(values_orig.begin(), values_orig.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    auto cmp = std::less<int>();
+
+    temporary_path value_path("values");
+    temporary_path index_path("index");
+
+    // Every benchmark starts from the unsorted file and sorts it in place. The
+    // file is likely in the page cache, so this measures copying and memory
+    // use rather than disk speed.
+    BENCHMARK_ADVANCED("read, boost index apply sort and write")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        write_file(value_path.string(), values_orig);
+
+        meter.measure(
+          [&value_path, &index_path, &cmp]
+          {
+              auto values = read_file<int>(value_path.string());
+              std::vector<std::uint64_t> index(values.size());
+              std::iota(index.begin(), index.end(), 0);
+
+              boost_index_apply_sort(values.begin(), values.end(),
+                                     index.begin(), index.end(), cmp);
+
+              write_file(value_path.string(), values);
+              write_file(index_path.string(), index);
+          });
+    };
+
+    BENCHMARK_ADVANCED("mapped boost index apply sort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        write_file(value_path.string(), values_orig);
+
+        meter.measure(
+          [&value_path, &index_path, &cmp]
+          {
+              mapped_array<int> values(value_path.string());
+              mapped_array<std::uint64_t> index(index_path.string(),
+                                                values.size());
+              std::iota(index.begin(), index.end(), 0);
+
+              mapped_boost_index_apply_sort(values, index, cmp);
+          });
+    };
+
+    BENCHMARK_ADVANCED("read, argsort and write index")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        write_file(value_path.string(), values_orig);
+
+        meter.measure(
+          [&value_path, &index_path, &cmp]
+          {
+              auto values = read_file<int>(value_path.string());
+              std::vector<std::uint64_t> index(values.size());
+              std::iota(index.begin(), index.end(), 0);
+
+              argsort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+
+              write_file(index_path.string(), index);
+          });
+    };
+
+    BENCHMARK_ADVANCED("mapped argsort")(Catch::Benchmark::Chronometer meter)
+    {
+        write_file(value_path.string(), values_orig);
+
+        meter.measure(
+          [&value_path, &index_path, &cmp]
+          {
+              mapped_array<const int> values(value_path.string());
+              mapped_array<std::uint64_t> index(index_path.string(),
+                                                values.size());
+              std::iota(index.begin(), index.end(), 0);
+
+              argsort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+          });
+    };
+}
+
+TEST_CASE("Benchmark multi-key sorting", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Table with a coarse first column, so that most rows are tied in it and
+    // must be ordered by the later columns.
+    std::vector<int> regions(length_of_values);
+    std::vector<double> prices(length_of_values);
+    std::vector<int> ids(length_of_values);
+
+    std::uniform_int_distribution<> region_distrib(0, 99);
+    std::uniform_int_distribution<> price_distrib(0, 9999);
+    std::uniform_int_distribution<> id_distrib;
+    for (int i = 0; i < length_of_values; ++i)
+    {
+        regions[i] = region_distrib(gen);
+        prices[i] = price_distrib(gen) / 100.0;
+        ids[i] = id_distrib(gen);
+    }
+
+    std::vector<int> index_orig(length_of_values);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    struct row
+    {
+        int region;
+        double price;
+        int id;
+
+        bool operator<(const row & other) const
+        {
+            return std::tie(region, other.price, id) <
+                   std::tie(other.region, price, other.id);
+        }
+    };
+
+    BENCHMARK_ADVANCED("multi-key argsort")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<int>> index(meter.runs(), index_orig);
+
+        meter.measure(
+          [&](int run)
+          {
+              multi_key_argsort(index[run].begin(), index[run].end(),
+                                column(regions.cbegin(), regions.cend()),
+                                column(prices.cbegin(), prices.cend(),
+                                       sort_direction::descending),
+                                column(ids.cbegin(), ids.cend()));
+          });
+    };
+
+    BENCHMARK_ADVANCED("argsort of rows packed into structs")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<int>> index(meter.runs(), index_orig);
+
+        meter.measure(
+          [&](int run)
+          {
+              std::vector<row> rows;
+              rows.reserve(length_of_values);
+              for (int i = 0; i < length_of_values; ++i)
+                  rows.push_back({regions[i], prices[i], ids[i]});
+
+              stable_argsort(rows.cbegin(), rows.cend(), index[run].begin(),
+                             index[run].end(), std::less<row>());
+          });
+    };
+
+    BENCHMARK_ADVANCED("stable sort of index with composite comparator")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<int>> index(meter.runs(), index_orig);
+
+        meter.measure(
+          [&](int run)
+          {
+              std::stable_sort(index[run].begin(), index[run].end(),
+                               [&](int a, int b)
+                               {
+                                   return std::tie(regions[a], prices[b],
+                                                   ids[a]) <
+                                          std::tie(regions[b], prices[a],
+                                                   ids[b]);
+                               });
+          });
+    };
+}
+
+TEST_CASE("Benchmark applying permutation to many columns", "[!benchmark]")
+{
+    constexpr int column_count = 20;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> index(length_of_values);
+    std::iota(index.begin(), index.end(), 0);
+    std::shuffle(index.begin(), index.end(), gen);
+
+    std::vector<std::vector<int>> columns(column_count,
+                                          std::vector<int>(length_of_values));
+    for (auto & column : columns)
+        std::iota(column.begin(), column.end(), 0);
+
+    using range =
+      std::pair<std::vector<int>::iterator, std::vector<int>::iterator>;
+
+    // Permutations applied to the columns accumulate, which doesn't change
+    // the cost.
+    BENCHMARK("boost apply permutation of every column (with index copy)")
+    {
+        for (auto & column : columns)
+        {
+            std::vector<int> temp(index.begin(), index.end());
+            boost::algorithm::apply_permutation(column.begin(), column.end(),
+                                                temp.begin(), temp.end());
+        }
+    };
+
+    BENCHMARK("cycle apply permutation of every column")
+    {
+        for (auto & column : columns)
+            apply_permutation(column.begin(), column.end(), index.begin(),
+                              index.end());
+    };
+
+    for (unsigned thread_count : {1u, std::thread::hardware_concurrency()})
+    {
+        BENCHMARK("apply permutation batch with " +
+                  std::to_string(thread_count) + " threads")
+        {
+            std::vector<range> ranges;
+            for (auto & column : columns)
+                ranges.emplace_back(column.begin(), column.end());
+
+            apply_permutation_batch(index.begin(), index.end(), ranges,
+                                    thread_count);
+        };
+    }
+}
+
+/**
+ * Benchmark sorting `values` with every algorithm whose memory traffic depends
+ * on the index type.
+ */
+template <typename Index, typename T>
+static void benchmark_index_type(const std::string & index_name,
+                                 const std::vector<T> & values)
+{
+    auto cmp = std::less<T>();
+    auto suffix = " with " + index_name + " index";
+
+    benchmark_algorithm<Index>("vector pair sort" + suffix, values, cmp,
+                               [](auto... args) { vector_pair_sort(args...); });
+    benchmark_algorithm<Index>(
+      "narrow vector pair sort" + suffix, values, cmp,
+      [](auto... args) { narrow_vector_pair_sort(args...); });
+    benchmark_algorithm<Index>(
+      "boost index apply sort" + suffix, values, cmp,
+      [](auto... args) { boost_index_apply_sort(args...); });
+    benchmark_algorithm<Index>("cycle apply sort" + suffix, values, cmp,
+                               [](auto... args) { cycle_apply_sort(args...); });
+    benchmark_algorithm<Index>("argsort" + suffix, values, cmp,
+                               [](auto... args) { argsort(args...); });
+}
+
+TEST_CASE("Benchmark index types", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<double> values(length_of_values);
+    std::uniform_real_distribution<> distrib(-1e6, 1e6);
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    benchmark_index_type<std::uint32_t>("uint32_t", values);
+    benchmark_index_type<std::uint64_t>("uint64_t", values);
+    benchmark_index_type<std::size_t>("size_t", values);
+}
+
+TEST_CASE("Benchmark appending to sorted values", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    auto cmp = std::less<int>();
+
+    // Sorted base followed by an unsorted tail of 0.1% to 50% of all values.
+    for (int tail_length : {1000, 10'000, 100'000, 500'000})
+    {
+        int base_length = length_of_values - tail_length;
+
+        std::vector<int> values(length_of_values);
+        std::generate(values.begin(), values.end(),
+                      [&gen, &distrib]() { return distrib(gen); });
+        std::sort(values.begin(), values.begin() + base_length);
+
+        auto suffix = " appending " + std::to_string(tail_length) + " values";
+
+        benchmark_algorithm("append sort" + suffix, values, cmp,
+                            [base_length](auto value_begin, auto value_end,
+                                          auto index_begin, auto index_end,
+                                          auto cmp)
+                            {
+                                append_sort(value_begin,
+                                            value_begin + base_length,
+                                            value_end, index_begin, index_end,
+                                            cmp);
+                            });
+        benchmark_algorithm("vector pair sort of all values" + suffix, values,
+                            cmp,
+                            [](auto... args) { vector_pair_sort(args...); });
+        benchmark_algorithm("sort of all values" + suffix, values, cmp,
+                            [](auto... args) { indexsort::sort(args...); });
+    }
+}
+
+TEST_CASE("Benchmark sorting presorted values", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    std::vector<int> values(length_of_values);
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    std::string distribution;
+
+    SECTION("random")
+    {
+        distribution = "random";
+    }
+    SECTION("sorted")
+    {
+        distribution = "sorted";
+        std::sort(values.begin(), values.end());
+    }
+    SECTION("reversed")
+    {
+        distribution = "reversed";
+        std::sort(values.begin(), values.end(), std::greater<int>());
+    }
+    SECTION("nearly sorted")
+    {
+        // 1% of values swapped to random positions.
+        distribution = "nearly sorted";
+        std::sort(values.begin(), values.end());
+        std::uniform_int_distribution<> position(0, length_of_values - 1);
+        for (int i = 0; i < length_of_values / 200; ++i)
+            std::swap(values[position(gen)], values[position(gen)]);
+    }
+    SECTION("sawtooth")
+    {
+        // Ascending runs of 10000 values.
+        distribution = "sawtooth";
+        for (int i = 0; i < length_of_values; ++i)
+            values[i] = i % 10000;
+    }
+    SECTION("few runs")
+    {
+        // 8 sorted runs, alternately ascending and descending.
+        distribution = "few runs";
+        constexpr int run_length = length_of_values / 8;
+        for (int run = 0; run < 8; ++run)
+        {
+            auto begin = values.begin() + run * run_length;
+            if (run % 2 == 0)
+                std::sort(begin, begin + run_length);
+            else
+                std::sort(begin, begin + run_length, std::greater<int>());
+        }
+    }
+
+    auto cmp = std::less<int>();
+    auto suffix = " of " + distribution + " values";
+
+    benchmark_algorithm("adaptive sort" + suffix, values, cmp,
+                        [](auto... args) { adaptive_sort(args...); });
+    benchmark_algorithm("sort" + suffix, values, cmp,
+                        [](auto... args) { indexsort::sort(args...); });
+    benchmark_algorithm("stable vector pair sort" + suffix, values, cmp,
+                        [](auto... args) { stable_vector_pair_sort(args...); });
+    benchmark_algorithm("vector pair sort" + suffix, values, cmp,
+                        [](auto... args) { vector_pair_sort(args...); });
+    benchmark_algorithm("permutate in place sort" + suffix, values, cmp,
+                        [](auto... args) { permutate_in_place_sort(args...); });
+    benchmark_algorithm("boost index apply sort" + suffix, values, cmp,
+                        [](auto... args) { boost_index_apply_sort(args...); });
+}
+
+TEST_CASE("Benchmark sorting string keys", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::uniform_int_distribution<> length_distrib(16, 48);
+    std::uniform_int_distribution<> char_distrib('a', 'z');
+    std::uniform_int_distribution<> host_distrib(0, 99);
+
+    std::vector<std::string> random_keys(length_of_values);
+    for (auto & key : random_keys)
+    {
+        key.resize(length_distrib(gen));
+        for (auto & c : key)
+            c = static_cast<char>(char_distrib(gen));
+    }
+
+    // Keys of log lines: a long common prefix, a few distinct hosts and
+    // many duplicates.
+    std::vector<std::string> log_keys(length_of_values);
+    for (auto & key : log_keys)
+        key = "2026-10-17 12:00:00 server-" +
+              std::to_string(host_distrib(gen)) + " GET /api/v1/" +
+              random_keys[host_distrib(gen) * 100].substr(0, 8);
+
+    for (const auto & [name, values] :
+         {std::pair("random", std::cref(random_keys)),
+          std::pair("log", std::cref(log_keys))})
+    {
+        auto cmp = std::less<std::string>();
+        auto suffix = std::string(" of ") + name + " keys";
+
+        benchmark_algorithm("string sort" + suffix, values.get(), cmp,
+                            [](auto... args) { string_sort(args...); });
+        benchmark_algorithm("stable string sort" + suffix, values.get(), cmp,
+                            [](auto... args) { stable_string_sort(args...); });
+        benchmark_algorithm("vector pair sort" + suffix, values.get(), cmp,
+                            [](auto... args) { vector_pair_sort(args...); });
+        benchmark_algorithm("cycle apply sort" + suffix, values.get(), cmp,
+                            [](auto... args) { cycle_apply_sort(args...); });
+        benchmark_algorithm("sort" + suffix, values.get(), cmp,
+                            [](auto... args) { indexsort::sort(args...); });
+    }
+}
+
+TEST_CASE("Benchmark ranking", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // About ten copies of every value, so that ties matter.
+    std::vector<double> values_double(length_of_values);
+    std::uniform_int_distribution<> distrib(0, length_of_values / 10);
+    std::generate(values_double.begin(), values_double.end(),
+                  [&gen, &distrib]() { return distrib(gen) * 0.5; });
+
+    std::vector<std::string> values_string;
+    values_string.reserve(length_of_large_values);
+    for (int i = 0; i < length_of_large_values; ++i)
+        values_string.push_back("key_" + std::to_string(distrib(gen)));
+
+    // What callers do today: argsort, then invert the index in a second
+    // pass, which reads the values again in sorted order to find ties.
+    auto sort_then_invert = [](rank_mode mode)
+    {
+        return [mode](auto value_begin, auto value_end, auto index_begin,
+                      auto index_end, auto cmp)
+        {
+            auto length = index_end - index_begin;
+            std::vector<int> sorted(length);
+            std::iota(sorted.begin(), sorted.end(), 0);
+            stable_argsort(value_begin, value_end, sorted.begin(),
+                           sorted.end(), cmp);
+
+            int shared = 0;
+            for (int i = 0; i < length; ++i)
+            {
+                bool tied =
+                  i != 0 && !cmp(value_begin[sorted[i - 1]],
+                                 value_begin[sorted[i]]);
+                if (mode == rank_mode::ordinal ||
+                    (mode == rank_mode::min && !tied))
+                    shared = i;
+                else if (mode == rank_mode::dense && !tied && i != 0)
+                    ++shared;
+                index_begin[sorted[i]] = shared;
+            }
+        };
+    };
+
+    auto benchmark_ranks = [&sort_then_invert](const std::string & type,
+                                               const auto & values)
+    {
+        using value_type = typename std::decay_t<decltype(values)>::value_type;
+        auto cmp = std::less<value_type>();
+
+        for (auto [mode, name] : {std::pair(rank_mode::ordinal, "ordinal"),
+                                  std::pair(rank_mode::dense, "dense")})
+        {
+            auto suffix = std::string(" ") + name + " ranks of " + type;
+
+            benchmark_algorithm(
+              "argrank" + suffix, values, cmp,
+              [mode](auto... args) { argrank(args..., mode); });
+            benchmark_algorithm("stable argsort then invert" + suffix, values,
+                                cmp, sort_then_invert(mode));
+        }
+    };
+
+    benchmark_ranks("doubles", values_double);
+    benchmark_ranks("strings", values_string);
+
+    // rank_sort returns sorted values, the index and the ranks.
+    auto cmp = std::less<double>();
+    benchmark_algorithm("rank sort with index and ranks of doubles",
+                        values_double, cmp,
+                        [](auto value_begin, auto value_end, auto index_begin,
+                           auto index_end, auto cmp)
+                        {
+                            std::vector<int> ranks(index_end - index_begin);
+                            rank_sort(value_begin, value_end, index_begin,
+                                      index_end, ranks.begin(), ranks.end(),
+                                      cmp);
+                        });
+    benchmark_algorithm("radix sort then invert index of doubles",
+                        values_double, cmp,
+                        [](auto value_begin, auto value_end, auto index_begin,
+                           auto index_end, auto cmp)
+                        {
+                            std::vector<int> ranks(index_end - index_begin);
+                            radix_sort(value_begin, value_end, index_begin,
+                                       index_end, cmp);
+                            for (int i = 0; i < index_end - index_begin; ++i)
+                                ranks[index_begin[i]] = i;
+                        });
+}
+
+TEST_CASE("Benchmark sorting few unique values", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    auto cmp = std::less<int>();
+
+    // Counting sort up to 1000 distinct values, three-way quicksort of
+    // 3000 and std::sort of more.
+    for (int distinct : {4, 100, 1000, 3000, 100'000})
+    {
+        std::vector<int> values(length_of_values);
+        std::uniform_int_distribution<> distrib(0, distinct - 1);
+        std::generate(values.begin(), values.end(),
+                      [&gen, &distrib]() { return distrib(gen) * 7919; });
+
+        auto suffix = " of " + std::to_string(distinct) + " distinct values";
+
+        benchmark_algorithm("few unique sort" + suffix, values, cmp,
+                            [](auto... args) { few_unique_sort(args...); });
+        benchmark_algorithm(
+          "stable few unique sort" + suffix, values, cmp,
+          [](auto... args) { stable_few_unique_sort(args...); });
+        benchmark_algorithm("vector pair sort" + suffix, values, cmp,
+                            [](auto... args) { vector_pair_sort(args...); });
+        benchmark_algorithm(
+          "stable vector pair sort" + suffix, values, cmp,
+          [](auto... args) { stable_vector_pair_sort(args...); });
+        benchmark_algorithm("double sort" + suffix, values, cmp,
+                            [](auto... args) { double_sort(args...); });
+    }
+
+    // Strings are expensive to compare, so fewer comparisons matter more.
+    std::vector<std::string> strings(length_of_large_values);
+    std::uniform_int_distribution<> distrib(0, 99);
+    std::generate(strings.begin(), strings.end(),
+                  [&gen, &distrib]()
+                  { return "category_" + std::to_string(distrib(gen)); });
+
+    auto cmp_string = std::less<std::string>();
+    benchmark_algorithm("few unique sort of 100 distinct strings", strings,
+                        cmp_string,
+                        [](auto... args) { few_unique_sort(args...); });
+    benchmark_algorithm("vector pair sort of 100 distinct strings", strings,
+                        cmp_string,
+                        [](auto... args) { vector_pair_sort(args...); });
+}
+
+TEST_CASE("Benchmark work stealing sort of skewed values", "[!benchmark]")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    auto cmp = std::less<int>();
+
+    std::vector<int> uniform(length_of_values);
+    std::uniform_int_distribution<> uniform_distrib(0, length_of_values);
+    std::generate(uniform.begin(), uniform.end(),
+                  [&gen, &uniform_distrib]() { return uniform_distrib(gen); });
+
+    // Most values are small and many are equal, so the chunks of parallel
+    // sort and the partitions of quicksort have very different costs.
+    std::vector<int> skewed(length_of_values);
+    std::geometric_distribution<> skewed_distrib(0.0001);
+    std::generate(skewed.begin(), skewed.end(),
+                  [&gen, &skewed_distrib]() { return skewed_distrib(gen); });
+
+    for (auto [name, values] : {std::pair("uniform", uniform),
+                                std::pair("skewed", skewed)})
+    {
+        auto suffix = std::string(" of ") + name + " values";
+
+        benchmark_algorithm("work stealing sort" + suffix, values, cmp,
+                            [](auto... args) { work_stealing_sort(args...); });
+        benchmark_algorithm(
+          "work stealing sort with a new pool" + suffix, values, cmp,
+          [](auto... args)
+          {
+              work_stealing_pool pool;
+              work_stealing_sort(args..., pool);
+          });
+        benchmark_algorithm("parallel sort" + suffix, values, cmp,
+                            [](auto... args) { parallel_sort(args...); });
+        benchmark_algorithm("vector pair sort" + suffix, values, cmp,
+                            [](auto... args) { vector_pair_sort(args...); });
+        benchmark_algorithm(
+          "stable work stealing sort" + suffix, values, cmp,
+          [](auto... args) { stable_work_stealing_sort(args...); });
+        benchmark_algorithm(
+          "stable parallel sort" + suffix, values, cmp,
+          [](auto... args) { stable_parallel_sort(args...); });
+    }
 }
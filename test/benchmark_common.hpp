@@ -0,0 +1,234 @@
+#ifndef BENCHMARK_COMMON_
+#define BENCHMARK_COMMON_
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Table row with a small sort key and a large payload. Rows are expensive to
+ * move around.
+ */
+struct large_row
+{
+    int key;
+    std::array<char, 196> payload;
+
+    bool operator<(const large_row & other) const
+    {
+        return key < other.key;
+    }
+};
+
+/**
+ * Benchmark `algorithm` sorting a copy of `values_orig` with `cmp` and an
+ * index of `Index`es.
+ */
+template <typename Index = int,
+          typename T,
+          typename Compare,
+          typename Algorithm>
+void benchmark_algorithm(std::string name,
+                         const std::vector<T> & values_orig,
+                         Compare cmp,
+                         Algorithm algorithm)
+{
+    std::vector<Index> index_orig(values_orig.size());
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    BENCHMARK_ADVANCED(std::move(name))(Catch::Benchmark::Chronometer meter)
+    {
+        // Short inputs are sorted many times per measurement. Every run gets
+        // its own copy, so that it doesn't sort already sorted values.
+        std::vector<std::vector<T>> values(meter.runs(), values_orig);
+        std::vector<std::vector<Index>> index(meter.runs(), index_orig);
+
+        meter.measure(
+          [&values, &index, &cmp, &algorithm](int run)
+          {
+              return algorithm(values[run].begin(), values[run].end(),
+                               index[run].begin(), index[run].end(), cmp);
+          });
+    };
+}
+
+/**
+ * Distribution of generated benchmark values.
+ */
+enum class distribution
+{
+    uniform,
+    zipf,
+    few_unique,
+    sorted,
+    reversed,
+    all_equal
+};
+
+constexpr std::array<distribution, 6> all_distributions = {
+  distribution::uniform,  distribution::zipf,     distribution::few_unique,
+  distribution::sorted,   distribution::reversed, distribution::all_equal};
+
+inline std::string distribution_name(distribution kind)
+{
+    switch (kind)
+    {
+    case distribution::uniform:
+        return "uniform";
+    case distribution::zipf:
+        return "zipf";
+    case distribution::few_unique:
+        return "few unique";
+    case distribution::sorted:
+        return "sorted";
+    case distribution::reversed:
+        return "reversed";
+    case distribution::all_equal:
+        return "all equal";
+    }
+    return "";
+}
+
+template <typename T>
+std::string type_name()
+{
+    if constexpr (std::is_same_v<T, std::int8_t>)
+        return "int8_t";
+    else if constexpr (std::is_same_v<T, std::int16_t>)
+        return "int16_t";
+    else if constexpr (std::is_same_v<T, std::int32_t>)
+        return "int32_t";
+    else if constexpr (std::is_same_v<T, std::int64_t>)
+        return "int64_t";
+    else if constexpr (std::is_same_v<T, float>)
+        return "float";
+    else if constexpr (std::is_same_v<T, double>)
+        return "double";
+    else if constexpr (std::is_same_v<T, std::string>)
+        return "string";
+    else if constexpr (std::is_same_v<T, large_row>)
+        return "large_row";
+}
+
+/**
+ * Value of rank `rank`. Values of higher ranks are greater, except for
+ * integers too narrow to hold the rank, which wrap around.
+ */
+template <typename T>
+T ranked_value(std::uint64_t rank)
+{
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        return static_cast<T>(rank);
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        // Zero padded, so that strings compare like their ranks. They are too
+        // long for the small string optimization, like most real keys.
+        std::string digits = std::to_string(rank);
+        return "key_" + std::string(20 - digits.size(), '0') + digits;
+    }
+    else
+    {
+        T value{};
+        value.key = static_cast<int>(rank);
+        return value;
+    }
+}
+
+/**
+ * Uniformly random value covering the whole range of integers, a wide range
+ * of floating point numbers and random keys of other types.
+ */
+template <typename T>
+T random_value(std::mt19937_64 & gen)
+{
+    if constexpr (std::is_floating_point_v<T>)
+        return std::uniform_real_distribution<T>(-1e9, 1e9)(gen);
+    else if constexpr (std::is_arithmetic_v<T>)
+        return static_cast<T>(gen());
+    else if constexpr (std::is_same_v<T, std::string>)
+        return ranked_value<T>(gen());
+    else
+        return ranked_value<T>(static_cast<std::uint32_t>(gen()));
+}
+
+/**
+ * Generate `length` values of the distribution `kind`.
+ *
+ * - `zipf`: rank `k` is drawn with probability roughly proportional to `1 / k`
+ *   out of `length` ranks, by exponentiating a uniform sample of
+ *   `log(length)`. A few values are very frequent and most are rare.
+ * - `few_unique`: 16 distinct values.
+ * - `sorted` and `reversed`: uniform values sorted in either direction.
+ */
+template <typename T>
+std::vector<T> generate_values(distribution kind,
+                               std::size_t length,
+                               std::mt19937_64 & gen)
+{
+    std::vector<T> values;
+    values.reserve(length);
+
+    switch (kind)
+    {
+    case distribution::uniform:
+    case distribution::sorted:
+    case distribution::reversed:
+        for (std::size_t i = 0; i < length; ++i)
+            values.push_back(random_value<T>(gen));
+        break;
+    case distribution::zipf:
+    {
+        std::uniform_real_distribution<double> exponent(
+          0.0, std::log(static_cast<double>(length) + 1));
+        for (std::size_t i = 0; i < length; ++i)
+            values.push_back(ranked_value<T>(
+              static_cast<std::uint64_t>(std::exp(exponent(gen)))));
+        break;
+    }
+    case distribution::few_unique:
+    {
+        std::uniform_int_distribution<std::uint64_t> rank(0, 15);
+        for (std::size_t i = 0; i < length; ++i)
+            values.push_back(ranked_value<T>(rank(gen) * 7));
+        break;
+    }
+    case distribution::all_equal:
+        values.assign(length, ranked_value<T>(42));
+        break;
+    }
+
+    if (kind == distribution::sorted)
+        std::sort(values.begin(), values.end());
+    if (kind == distribution::reversed)
+        std::sort(values.begin(), values.end(),
+                  [](const T & a, const T & b) { return b < a; });
+
+    return values;
+}
+
+/**
+ * Largest length benchmarked by the suite, read from the environment
+ * variable `INDEXSORT_BENCHMARK_MAX_LENGTH`. The default of one million keeps
+ * a full run of the suite short enough for development.
+ */
+inline std::size_t benchmark_max_length()
+{
+    const char * max_length = std::getenv("INDEXSORT_BENCHMARK_MAX_LENGTH");
+    if (max_length == nullptr || *max_length == '\0')
+        return 1'000'000;
+
+    return static_cast<std::size_t>(std::stoull(max_length));
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <type_traits>
+#include "adaptive_sort.hpp"
+#include "argsort.hpp"
+#include "benchmark_common.hpp"
+#include "boost_index_apply_sort.hpp"
+#include "boost_index_apply_sort2.hpp"
+#include "branchless_quick_sort.hpp"
+#include "cycle_apply_sort.hpp"
+#include "double_sort.hpp"
+#include "few_unique_sort.hpp"
+#include "packed_sort.hpp"
+#include "parallel_sort.hpp"
+#include "permutate_in_place_sort.hpp"
+#include "radix_sort.hpp"
+#include "sort.hpp"
+#include "vector_pair_sort.hpp"
+#include "vector_pair_sort2.hpp"
+#include "work_stealing_sort.hpp"
+
+using namespace indexsort;
+
+/*
+ * Parameterized benchmark suite. Every algorithm which accepts any value type
+ * and comparator, including the stable variations, is benchmarked for every
+ * combination of value type, distribution and length. Algorithms limited to
+ * integers and floating point numbers are benchmarked for those types.
+ * Benchmarks are named "algorithm / type / distribution / length", so that
+ * compare_benchmarks.py can split results from the XML reporter into columns.
+ *
+ * Lengths go from 10 to 100 million values, limited by the environment
+ * variable INDEXSORT_BENCHMARK_MAX_LENGTH (one million by default).
+ */
+
+constexpr std::size_t suite_lengths[] = {
+  10, 1'000, 100'000, 1'000'000, 10'000'000, 100'000'000};
+
+TEMPLATE_TEST_CASE("Benchmark suite",
+                   "[!benchmark][suite]",
+                   std::int8_t,
+                   std::int16_t,
+                   std::int32_t,
+                   std::int64_t,
+                   float,
+                   double,
+                   std::string,
+                   large_row)
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937_64 gen(rng_seed);
+
+    auto cmp = std::less<TestType>();
+    auto max_length = benchmark_max_length();
+
+    for (auto kind : all_distributions)
+    {
+        for (std::size_t length : suite_lengths)
+        {
+            if (length > max_length)
+                break;
+
+            auto values = generate_values<TestType>(kind, length, gen);
+            auto suffix = " / " + type_name<TestType>() + " / " +
+                          distribution_name(kind) + " / " +
+                          std::to_string(length);
+
+            benchmark_algorithm(
+              "sort" + suffix, values, cmp,
+              [](auto... args) { indexsort::sort(args...); });
+            benchmark_algorithm(
+              "stable sort" + suffix, values, cmp,
+              [](auto... args) { indexsort::stable_sort(args...); });
+            benchmark_algorithm(
+              "vector pair sort" + suffix, values, cmp,
+              [](auto... args) { vector_pair_sort(args...); });
+            benchmark_algorithm(
+              "stable vector pair sort" + suffix, values, cmp,
+              [](auto... args) { stable_vector_pair_sort(args...); });
+            benchmark_algorithm(
+              "narrow vector pair sort" + suffix, values, cmp,
+              [](auto... args) { narrow_vector_pair_sort(args...); });
+            benchmark_algorithm(
+              "stable narrow vector pair sort" + suffix, values, cmp,
+              [](auto... args) { stable_narrow_vector_pair_sort(args...); });
+            benchmark_algorithm(
+              "vector pair sort 2" + suffix, values, cmp,
+              [](auto... args) { vector_pair_sort2(args...); });
+            benchmark_algorithm(
+              "stable vector pair sort 2" + suffix, values, cmp,
+              [](auto... args) { stable_vector_pair_sort2(args...); });
+            benchmark_algorithm("double sort" + suffix, values, cmp,
+                                [](auto... args) { double_sort(args...); });
+            benchmark_algorithm(
+              "stable double sort" + suffix, values, cmp,
+              [](auto... args) { stable_double_sort(args...); });
+            benchmark_algorithm(
+              "boost index apply sort" + suffix, values, cmp,
+              [](auto... args) { boost_index_apply_sort(args...); });
+            benchmark_algorithm(
+              "stable boost index apply sort" + suffix, values, cmp,
+              [](auto... args) { stable_boost_index_apply_sort(args...); });
+            benchmark_algorithm(
+              "boost index apply sort 2" + suffix, values, cmp,
+              [](auto... args) { boost_index_apply_sort2(args...); });
+            benchmark_algorithm(
+              "stable boost index apply sort 2" + suffix, values, cmp,
+              [](auto... args) { stable_boost_index_apply_sort2(args...); });
+            benchmark_algorithm(
+              "permutate in place sort" + suffix, values, cmp,
+              [](auto... args) { permutate_in_place_sort(args...); });
+            benchmark_algorithm(
+              "stable permutate in place sort" + suffix, values, cmp,
+              [](auto... args) { stable_permutate_in_place_sort(args...); });
+            benchmark_algorithm(
+              "cycle apply sort" + suffix, values, cmp,
+              [](auto... args) { cycle_apply_sort(args...); });
+            benchmark_algorithm(
+              "stable cycle apply sort" + suffix, values, cmp,
+              [](auto... args) { stable_cycle_apply_sort(args...); });
+            benchmark_algorithm("argsort" + suffix, values, cmp,
+                                [](auto... args) { argsort(args...); });
+            benchmark_algorithm("stable argsort" + suffix, values, cmp,
+                                [](auto... args) { stable_argsort(args...); });
+            benchmark_algorithm(
+              "adaptive sort" + suffix, values, cmp,
+              [](auto... args) { adaptive_sort(args...); });
+            benchmark_algorithm(
+              "few unique sort" + suffix, values, cmp,
+              [](auto... args) { few_unique_sort(args...); });
+            benchmark_algorithm(
+              "stable few unique sort" + suffix, values, cmp,
+              [](auto... args) { stable_few_unique_sort(args...); });
+            benchmark_algorithm(
+              "parallel sort" + suffix, values, cmp,
+              [](auto... args) { parallel_sort(args...); });
+            benchmark_algorithm(
+              "stable parallel sort" + suffix, values, cmp,
+              [](auto... args) { stable_parallel_sort(args...); });
+            benchmark_algorithm(
+              "work stealing sort" + suffix, values, cmp,
+              [](auto... args) { work_stealing_sort(args...); });
+            benchmark_algorithm(
+              "stable work stealing sort" + suffix, values, cmp,
+              [](auto... args) { stable_work_stealing_sort(args...); });
+
+            // Algorithms for integers and floating point numbers only, the
+            // candidates of sort() for them.
+            if constexpr (std::is_arithmetic_v<TestType>)
+            {
+                benchmark_algorithm("radix sort" + suffix, values, cmp,
+                                    [](auto... args) { radix_sort(args...); });
+                benchmark_algorithm("packed sort" + suffix, values, cmp,
+                                    [](auto... args) { packed_sort(args...); });
+                benchmark_algorithm(
+                  "branchless quick sort" + suffix, values, cmp,
+                  [](auto... args) { branchless_quick_sort(args...); });
+            }
+        }
+    }
+}
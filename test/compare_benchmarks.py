@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Convert benchmark results and compare them against a baseline.
+
+Results are read from the XML reporter of Catch2, for example:
+
+    tests '[suite]' --reporter xml --out results.xml
+
+Names of the benchmark suite ("algorithm / type / distribution / length") are
+split into columns. Other benchmarks keep their whole name as the algorithm.
+
+    compare_benchmarks.py results.xml --csv results.csv
+    compare_benchmarks.py results.xml --baseline baseline.xml
+
+Baselines may be XML results or CSV files written by --csv. A benchmark whose
+mean time grew by more than --threshold (10 % by default) against the baseline
+is reported as a regression and the script exits with status 1, unless the
+difference is within the noise: the confidence intervals of both means, as
+reported by the statistical analysis of Catch2, must not overlap. Results
+without an interval, for example from --benchmark-no-analysis, use the mean
+plus or minus the standard deviation instead.
+"""
+
+import argparse
+import csv
+import sys
+import xml.etree.ElementTree as ElementTree
+
+COLUMNS = ["algorithm", "type", "distribution", "length", "mean_ns",
+           "lower_bound_ns", "upper_bound_ns", "standard_deviation_ns"]
+NAME_COLUMNS = COLUMNS[:4]
+
+
+def split_name(name):
+    parts = [part.strip() for part in name.split(" / ")]
+    if len(parts) != 4:
+        return {"algorithm": name, "type": "", "distribution": "", "length": ""}
+    return dict(zip(NAME_COLUMNS, parts))
+
+
+def make_result(mean, lower_bound=None, upper_bound=None, deviation=0.0):
+    return {
+        "mean": mean,
+        "lower_bound": mean if lower_bound is None else lower_bound,
+        "upper_bound": mean if upper_bound is None else upper_bound,
+        "standard_deviation": deviation,
+    }
+
+
+def interval(result):
+    """Range in which the mean probably lies."""
+    if result["upper_bound"] > result["lower_bound"]:
+        return result["lower_bound"], result["upper_bound"]
+    return (result["mean"] - result["standard_deviation"],
+            result["mean"] + result["standard_deviation"])
+
+
+def read_xml(path):
+    results = {}
+    for benchmark in ElementTree.parse(path).iter("BenchmarkResults"):
+        mean = benchmark.find("mean")
+        if mean is None:
+            continue
+        deviation = benchmark.find("standardDeviation")
+        results[benchmark.get("name")] = make_result(
+            float(mean.get("value")),
+            float(mean.get("lowerBound", mean.get("value"))),
+            float(mean.get("upperBound", mean.get("value"))),
+            0.0 if deviation is None else float(deviation.get("value")))
+    return results
+
+
+def optional_float(row, column):
+    value = row.get(column)
+    return float(value) if value else None
+
+
+def read_csv(path):
+    results = {}
+    with open(path, newline="") as file:
+        for row in csv.DictReader(file):
+            name = row["algorithm"]
+            if row["type"]:
+                name = " / ".join(row[column] for column in NAME_COLUMNS)
+            # Baselines written before the bounds were recorded have only
+            # the mean.
+            results[name] = make_result(
+                float(row["mean_ns"]),
+                optional_float(row, "lower_bound_ns"),
+                optional_float(row, "upper_bound_ns"),
+                optional_float(row, "standard_deviation_ns") or 0.0)
+    return results
+
+
+def read_results(path):
+    return read_csv(path) if path.endswith(".csv") else read_xml(path)
+
+
+def write_csv(path, results):
+    with open(path, "w", newline="") as file:
+        writer = csv.DictWriter(file, fieldnames=COLUMNS)
+        writer.writeheader()
+        for name, result in results.items():
+            writer.writerow(dict(
+                split_name(name),
+                mean_ns=result["mean"],
+                lower_bound_ns=result["lower_bound"],
+                upper_bound_ns=result["upper_bound"],
+                standard_deviation_ns=result["standard_deviation"]))
+
+
+def compare(results, baseline, threshold):
+    regressions = 0
+    noisy = 0
+    for name, result in results.items():
+        if name not in baseline:
+            continue
+        old = baseline[name]
+        ratio = result["mean"] / old["mean"] if old["mean"] > 0 else 1.0
+        if abs(ratio - 1) <= threshold:
+            continue
+
+        lower, upper = interval(result)
+        old_lower, old_upper = interval(old)
+        if ratio > 1 and lower > old_upper:
+            status = "REGRESSION"
+            regressions += 1
+        elif ratio < 1 and upper < old_lower:
+            status = "improvement"
+        else:
+            noisy += 1
+            continue
+        print(f"{status:>11} {ratio:6.2f}x  {name}: "
+              f"{old['mean']:.0f} ns -> {result['mean']:.0f} ns "
+              f"(interval {lower:.0f} - {upper:.0f} ns, "
+              f"baseline {old_lower:.0f} - {old_upper:.0f} ns)")
+
+    missing = sorted(set(baseline) - set(results))
+    for name in missing:
+        print(f"{'missing':>11}          {name}")
+
+    print(f"{len(results)} benchmarks, {regressions} regressions, "
+          f"{noisy} differences within the noise")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert and compare Catch2 benchmark results.")
+    parser.add_argument("results", help="XML or CSV results")
+    parser.add_argument("--csv", help="write the results to this CSV file")
+    parser.add_argument("--baseline", help="XML or CSV results to compare to")
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="relative slowdown reported as a regression")
+    args = parser.parse_args()
+
+    results = read_results(args.results)
+    if args.csv:
+        write_csv(args.csv, results)
+    if args.baseline:
+        baseline = read_results(args.baseline)
+        if compare(results, baseline, args.threshold) > 0:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,63 @@
+#ifndef TEMPORARY_FILE_
+#define TEMPORARY_FILE_
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Path to a file in the temporary directory which is removed when the object
+ * goes out of scope.
+ */
+struct temporary_path
+{
+    explicit temporary_path(const std::string & name)
+    {
+        std::random_device device;
+        path = std::filesystem::temp_directory_path() /
+               ("indexsort_" + name + "_" + std::to_string(device()));
+    }
+
+    ~temporary_path()
+    {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+
+    std::string string() const
+    {
+        return path.string();
+    }
+
+    std::filesystem::path path;
+};
+
+template <typename T>
+inline std::vector<T> read_file(const std::string & path)
+{
+    std::vector<T> data(std::filesystem::file_size(path) / sizeof(T));
+
+    std::FILE * file = std::fopen(path.c_str(), "rb");
+    REQUIRE(file != nullptr);
+    REQUIRE(std::fread(data.data(), sizeof(T), data.size(), file) ==
+            data.size());
+    std::fclose(file);
+
+    return data;
+}
+
+template <typename T>
+inline void write_file(const std::string & path, const std::vector<T> & data)
+{
+    std::FILE * file = std::fopen(path.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    REQUIRE(std::fwrite(data.data(), sizeof(T), data.size(), file) ==
+            data.size());
+    std::fclose(file);
+}
+
+#endif
@@ -2,13 +2,40 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
 #include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include "adaptive_sort.hpp"
+#include "append_sort.hpp"
+#include "apply_permutation.hpp"
+#include "argsort.hpp"
 #include "boost_index_apply_sort.hpp"
 #include "boost_index_apply_sort2.hpp"
+#include "branchless_quick_sort.hpp"
+#include "cycle_apply_sort.hpp"
 #include "double_sort.hpp"
+#include "few_unique_sort.hpp"
+#include "multi_key_sort.hpp"
+#include "packed_sort.hpp"
+#include "parallel_sort.hpp"
+#include "partial_sort.hpp"
 #include "permutate_in_place_sort.hpp"
+#include "radix_sort.hpp"
+#include "rank.hpp"
+#include "scratch_arena.hpp"
+#include "sort.hpp"
+#include "sorting_network.hpp"
+#include "string_sort.hpp"
 #include "vector_pair_sort.hpp"
 #include "vector_pair_sort2.hpp"
+#include "work_stealing_pool.hpp"
+#include "work_stealing_sort.hpp"
 
 /*
  * test_vector_pair_sort.hpp tests the correctness of vector_pair_sort(). Tests
@@ -72,17 +99,145 @@ TEST_CASE("Test sorting")
         permutate_in_place_sort(values.begin(), values.end(), index.begin(),
                                 index.end(), cmp);
     }
+    SECTION("Test radix sort")
+    {
+        radix_sort(values.begin(), values.end(), index.begin(), index.end(),
+                   cmp);
+    }
+    SECTION("Test parallel sort")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test parallel sort with 7 threads")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp, 7);
+    }
+    SECTION("Test packed sort")
+    {
+        packed_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test branchless quick sort")
+    {
+        branchless_quick_sort(values.begin(), values.end(), index.begin(),
+                              index.end(), cmp);
+    }
+    SECTION("Test stable vector pair sort")
+    {
+        stable_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test stable vector pair sort 2")
+    {
+        stable_vector_pair_sort2(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
+    }
+    SECTION("Test stable double sort")
+    {
+        stable_double_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+    }
+    SECTION("Test stable boost index apply sort")
+    {
+        stable_boost_index_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable boost index apply sort 2")
+    {
+        stable_boost_index_apply_sort2(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable permutate in place sort")
+    {
+        stable_permutate_in_place_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable parallel sort")
+    {
+        stable_parallel_sort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+    }
+    SECTION("Test cycle apply sort")
+    {
+        cycle_apply_sort(values.begin(), values.end(), index.begin(),
+                         index.end(), cmp);
+    }
+    SECTION("Test sort")
+    {
+        sort(values.begin(), values.end(), index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable sort")
+    {
+        stable_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test narrow vector pair sort")
+    {
+        narrow_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test stable narrow vector pair sort")
+    {
+        stable_narrow_vector_pair_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test adaptive sort")
+    {
+        adaptive_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test few unique sort")
+    {
+        few_unique_sort(values.begin(), values.end(), index.begin(),
+                        index.end(), cmp);
+    }
+    SECTION("Test stable few unique sort")
+    {
+        stable_few_unique_sort(values.begin(), values.end(), index.begin(),
+                               index.end(), cmp);
+    }
+    SECTION("Test work stealing sort")
+    {
+        work_stealing_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+    }
+    SECTION("Test stable work stealing sort")
+    {
+        stable_work_stealing_sort(values.begin(), values.end(), index.begin(),
+                                  index.end(), cmp);
+    }
 
     REQUIRE(values == check_values);
     REQUIRE(index == check_index);
 }
 
-TEST_CASE("Test sorting empty containers")
+TEST_CASE("Test sorting doubles in descending order")
 {
-    std::vector<int> values;
-    std::vector<int> index;
+    constexpr int vector_length = 500;
 
-    auto cmp = std::less<int>();
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Initialize values with random numbers of both signs.
+    std::vector<double> values(vector_length);
+
+    std::uniform_real_distribution<> distrib(-1000.0, 1000.0);
+
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    // Initialize index with sequence.
+    std::vector<int> index(values.size());
+    std::iota(index.begin(), index.end(), 0);
+
+    auto cmp = std::greater<double>();
+
+    auto check_values(values);
+    auto check_index(index);
+    vector_pair_sort(check_values.begin(), check_values.end(),
+                     check_index.begin(), check_index.end(), cmp);
 
     SECTION("Test vector pair sort 2")
     {
@@ -109,87 +264,2104 @@ TEST_CASE("Test sorting empty containers")
         permutate_in_place_sort(values.begin(), values.end(), index.begin(),
                                 index.end(), cmp);
     }
+    SECTION("Test radix sort")
+    {
+        radix_sort(values.begin(), values.end(), index.begin(), index.end(),
+                   cmp);
+    }
+    SECTION("Test parallel sort")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test parallel sort with 7 threads")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp, 7);
+    }
+    SECTION("Test packed sort")
+    {
+        packed_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test branchless quick sort")
+    {
+        branchless_quick_sort(values.begin(), values.end(), index.begin(),
+                              index.end(), cmp);
+    }
+    SECTION("Test stable vector pair sort")
+    {
+        stable_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test stable vector pair sort 2")
+    {
+        stable_vector_pair_sort2(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
+    }
+    SECTION("Test stable double sort")
+    {
+        stable_double_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+    }
+    SECTION("Test stable boost index apply sort")
+    {
+        stable_boost_index_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable boost index apply sort 2")
+    {
+        stable_boost_index_apply_sort2(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable permutate in place sort")
+    {
+        stable_permutate_in_place_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable parallel sort")
+    {
+        stable_parallel_sort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+    }
+    SECTION("Test cycle apply sort")
+    {
+        cycle_apply_sort(values.begin(), values.end(), index.begin(),
+                         index.end(), cmp);
+    }
+    SECTION("Test sort")
+    {
+        sort(values.begin(), values.end(), index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable sort")
+    {
+        stable_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test narrow vector pair sort")
+    {
+        narrow_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test stable narrow vector pair sort")
+    {
+        stable_narrow_vector_pair_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test adaptive sort")
+    {
+        adaptive_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test few unique sort")
+    {
+        few_unique_sort(values.begin(), values.end(), index.begin(),
+                        index.end(), cmp);
+    }
+    SECTION("Test stable few unique sort")
+    {
+        stable_few_unique_sort(values.begin(), values.end(), index.begin(),
+                               index.end(), cmp);
+    }
+    SECTION("Test work stealing sort")
+    {
+        work_stealing_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+    }
+    SECTION("Test stable work stealing sort")
+    {
+        stable_work_stealing_sort(values.begin(), values.end(), index.begin(),
+                                  index.end(), cmp);
+    }
 
-    REQUIRE(values.empty());
-    REQUIRE(index.empty());
+    REQUIRE(values == check_values);
+    REQUIRE(index == check_index);
 }
 
-TEST_CASE("Test sorting container with invalid length of index")
+TEST_CASE("Test stable sorting with duplicate keys")
 {
-    std::vector<int> values({7, 45, 18, 33, 77, 96, 83, 80, 4, 51});
+    constexpr int vector_length = 2000;
 
-    auto cmp = std::less<int>();
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
 
-    using iterator_type = decltype(values)::iterator;
-    void (*function)(iterator_type, iterator_type, iterator_type, iterator_type,
-                     std::less<int>);
+    // Initialize values with random numbers from a small range, so that every
+    // value is repeated many times.
+    std::vector<int> values(vector_length);
 
-    SECTION("Test vector pair sort 2")
+    std::uniform_int_distribution<> distrib(0, 9);
+
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    // Initialize index with sequence.
+    std::vector<int> index(values.size());
+    std::iota(index.begin(), index.end(), 0);
+
+    // Stable sorting the index by values gives the only valid result.
+    auto check_index(index);
+    std::stable_sort(check_index.begin(), check_index.end(),
+                     [&values](int a, int b) { return values[a] < values[b]; });
+    std::vector<int> check_values;
+    for (int i : check_index)
+        check_values.push_back(values[i]);
+
+    auto cmp = std::less<int>();
+
+    SECTION("Test stable vector pair sort")
     {
-        function =
-          vector_pair_sort2<decltype(values)::iterator,
-                            decltype(values)::iterator, std::less<int>>;
+        stable_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
     }
-    SECTION("Test double sort")
+    SECTION("Test stable vector pair sort 2")
     {
-        function = double_sort<decltype(values)::iterator,
-                               decltype(values)::iterator, std::less<int>>;
+        stable_vector_pair_sort2(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
     }
-    SECTION("Test boost index apply sort")
+    SECTION("Test stable double sort")
     {
-        function =
-          boost_index_apply_sort<decltype(values)::iterator,
-                                 decltype(values)::iterator, std::less<int>>;
+        stable_double_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
     }
-    SECTION("Test boost index apply sort 2")
+    SECTION("Test stable boost index apply sort")
     {
-        function =
-          boost_index_apply_sort2<decltype(values)::iterator,
-                                  decltype(values)::iterator, std::less<int>>;
+        stable_boost_index_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
     }
-    SECTION("Test permutate in place sort")
+    SECTION("Test stable boost index apply sort 2")
     {
-        function =
-          permutate_in_place_sort<decltype(values)::iterator,
-                                  decltype(values)::iterator, std::less<int>>;
+        stable_boost_index_apply_sort2(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
     }
-
-    std::vector<int> index_too_large({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
-    try
+    SECTION("Test stable permutate in place sort")
     {
-        function(values.begin(), values.end(), index_too_large.begin(),
-                 index_too_large.end(), cmp);
-        FAIL(
-          "Test with too large index: function didn't throw "
-          "indexsort::length_mismatch_error.");
+        stable_permutate_in_place_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
     }
-    catch (indexsort::length_mismatch_error &)
+    SECTION("Test stable parallel sort")
+    {
+        stable_parallel_sort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+    }
+    SECTION("Test stable parallel sort with 7 threads")
+    {
+        stable_parallel_sort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp, 7);
+    }
+    SECTION("Test stable cycle apply sort")
+    {
+        stable_cycle_apply_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test radix sort")
+    {
+        radix_sort(values.begin(), values.end(), index.begin(), index.end(),
+                   cmp);
+    }
+    SECTION("Test packed sort")
+    {
+        packed_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test branchless quick sort")
+    {
+        branchless_quick_sort(values.begin(), values.end(), index.begin(),
+                              index.end(), cmp);
+    }
+    SECTION("Test stable sort")
+    {
+        stable_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test adaptive sort")
+    {
+        adaptive_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test stable narrow vector pair sort")
     {
+        stable_narrow_vector_pair_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable few unique sort")
+    {
+        stable_few_unique_sort(values.begin(), values.end(), index.begin(),
+                               index.end(), cmp);
+    }
+    SECTION("Test stable work stealing sort")
+    {
+        stable_work_stealing_sort(values.begin(), values.end(), index.begin(),
+                                  index.end(), cmp);
     }
 
-    std::vector<int> index_too_small({0, 1, 2, 3, 4, 5, 6, 7, 8});
-    try
+    REQUIRE(values == check_values);
+    REQUIRE(index == check_index);
+}
+
+TEST_CASE("Test stable sorting of negative and positive zeros")
+{
+    constexpr int vector_length = 2000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // -0.0 and 0.0 are equal for std::less, so stable algorithms must keep
+    // them in their original order. 0.0 comes first, before any -0.0.
+    std::vector<double> values({0.0, -0.0});
+    std::uniform_int_distribution<> distrib(0, 3);
+    const std::array<double, 4> choices({-1.0, -0.0, 0.0, 1.0});
+    while (values.size() < vector_length)
+        values.push_back(choices[distrib(gen)]);
+    const auto values_orig = values;
+
+    std::vector<int> index(values.size());
+    std::iota(index.begin(), index.end(), 0);
+
+    auto check_index(index);
+    std::stable_sort(check_index.begin(), check_index.end(),
+                     [&values](int a, int b) { return values[a] < values[b]; });
+
+    auto cmp = std::less<double>();
+    bool values_sorted = true;
+
+    SECTION("Test radix sort")
     {
-        function(values.begin(), values.end(), index_too_small.begin(),
-                 index_too_small.end(), cmp);
-        FAIL(
-          "Test with too small index: function didn't throw "
-          "indexsort::length_mismatch_error.");
+        radix_sort(values.begin(), values.end(), index.begin(), index.end(),
+                   cmp);
     }
-    catch (indexsort::length_mismatch_error &)
+    SECTION("Test packed sort")
+    {
+        packed_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test branchless quick sort")
     {
+        branchless_quick_sort(values.begin(), values.end(), index.begin(),
+                              index.end(), cmp);
+    }
+    SECTION("Test stable sort")
+    {
+        stable_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test rank sort")
+    {
+        std::vector<int> ranks(values.size());
+        rank_sort(values.begin(), values.end(), index.begin(), index.end(),
+                  ranks.begin(), ranks.end(), cmp);
+    }
+    SECTION("Test stable argsort")
+    {
+        stable_argsort(values.begin(), values.end(), index.begin(),
+                       index.end(), cmp);
+        values_sorted = false;
+    }
+    SECTION("Test multi-key argsort")
+    {
+        multi_key_argsort(index.begin(), index.end(),
+                          column(values.begin(), values.end()));
+        values_sorted = false;
     }
 
-    std::vector<int> index_empty({0, 1, 2, 3, 4, 5, 6, 7, 8});
-    try
+    REQUIRE(index == check_index);
+    for (std::size_t i = 0; i < values.size(); ++i)
     {
-        function(values.begin(), values.end(), index_empty.begin(),
-                 index_empty.end(), cmp);
-        FAIL(
-          "Test with empty index: function didn't throw "
-          "indexsort::length_mismatch_error.");
+        double expected = values_orig[values_sorted ? index[i] : i];
+        REQUIRE(values[i] == expected);
+        REQUIRE(std::signbit(values[i]) == std::signbit(expected));
     }
-    catch (indexsort::length_mismatch_error &)
+}
+
+TEST_CASE("Test sorting negative and positive zeros packed with the index")
+{
+    // Keys of floats are packed together with a 32-bit index.
+    std::vector<float> values({0.0f, -0.0f, 1.0f, -0.0f, 0.0f, -1.0f});
+    std::vector<int> index(values.size());
+    std::iota(index.begin(), index.end(), 0);
+
+    SECTION("Test packed sort")
     {
+        packed_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    std::less<float>());
+    }
+    SECTION("Test branchless quick sort")
+    {
+        branchless_quick_sort(values.begin(), values.end(), index.begin(),
+                              index.end(), std::less<float>());
+    }
+
+    REQUIRE(index == std::vector<int>({5, 0, 1, 3, 4, 2}));
+    REQUIRE(std::signbit(values[1]) == false);
+    REQUIRE(std::signbit(values[2]) == true);
+    REQUIRE(std::signbit(values[3]) == true);
+    REQUIRE(std::signbit(values[4]) == false);
+}
+
+TEST_CASE("Test sorting move-only values")
+{
+    constexpr int vector_length = 500;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Initialize keys with random numbers and values with pointers to them.
+    std::vector<int> keys(vector_length);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    std::generate(keys.begin(), keys.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    using pointer = std::unique_ptr<int>;
+
+    std::vector<pointer> values;
+    for (int key : keys)
+        values.push_back(std::make_unique<int>(key));
+
+    // Initialize index with sequence.
+    std::vector<int> index(values.size());
+    std::iota(index.begin(), index.end(), 0);
+
+    auto cmp = [](const pointer & a, const pointer & b) { return *a < *b; };
+
+    SECTION("Test vector pair sort")
+    {
+        vector_pair_sort(values.begin(), values.end(), index.begin(),
+                         index.end(), cmp);
+    }
+    SECTION("Test adaptive sort")
+    {
+        adaptive_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test few unique sort")
+    {
+        few_unique_sort(values.begin(), values.end(), index.begin(),
+                        index.end(), cmp);
+    }
+    SECTION("Test narrow vector pair sort")
+    {
+        narrow_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test vector pair sort 2")
+    {
+        vector_pair_sort2(values.begin(), values.end(), index.begin(),
+                          index.end(), cmp);
+    }
+    SECTION("Test double sort")
+    {
+        double_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test boost index apply sort")
+    {
+        boost_index_apply_sort(values.begin(), values.end(), index.begin(),
+                               index.end(), cmp);
+    }
+    SECTION("Test boost index apply sort 2")
+    {
+        boost_index_apply_sort2(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test permutate in place sort")
+    {
+        permutate_in_place_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test cycle apply sort")
+    {
+        cycle_apply_sort(values.begin(), values.end(), index.begin(),
+                         index.end(), cmp);
+    }
+    SECTION("Test parallel sort")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test parallel sort with 7 threads")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp, 7);
+    }
+    SECTION("Test stable vector pair sort")
+    {
+        stable_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test stable parallel sort")
+    {
+        stable_parallel_sort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+    }
+    SECTION("Test sort")
+    {
+        sort(values.begin(), values.end(), index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable sort")
+    {
+        stable_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test work stealing sort")
+    {
+        work_stealing_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+    }
+    SECTION("Test stable work stealing sort")
+    {
+        stable_work_stealing_sort(values.begin(), values.end(), index.begin(),
+                                  index.end(), cmp);
+    }
+
+    std::vector<int> sorted_keys;
+    for (const auto & value : values)
+        sorted_keys.push_back(*value);
+
+    REQUIRE(std::is_sorted(sorted_keys.begin(), sorted_keys.end()));
+    for (int i = 0; i < vector_length; ++i)
+        REQUIRE(sorted_keys[i] == keys[index[i]]);
+}
+
+TEST_CASE("Test sorting empty containers")
+{
+    std::vector<int> values;
+    std::vector<int> index;
+
+    auto cmp = std::less<int>();
+
+    SECTION("Test vector pair sort 2")
+    {
+        vector_pair_sort2(values.begin(), values.end(), index.begin(),
+                          index.end(), cmp);
+    }
+    SECTION("Test double sort")
+    {
+        double_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test boost index apply sort")
+    {
+        boost_index_apply_sort(values.begin(), values.end(), index.begin(),
+                               index.end(), cmp);
+    }
+    SECTION("Test boost index apply sort 2")
+    {
+        boost_index_apply_sort2(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test permutate in place sort")
+    {
+        permutate_in_place_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test radix sort")
+    {
+        radix_sort(values.begin(), values.end(), index.begin(), index.end(),
+                   cmp);
+    }
+    SECTION("Test parallel sort")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test parallel sort with 7 threads")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp, 7);
+    }
+    SECTION("Test packed sort")
+    {
+        packed_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test branchless quick sort")
+    {
+        branchless_quick_sort(values.begin(), values.end(), index.begin(),
+                              index.end(), cmp);
+    }
+    SECTION("Test stable vector pair sort")
+    {
+        stable_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test stable vector pair sort 2")
+    {
+        stable_vector_pair_sort2(values.begin(), values.end(), index.begin(),
+                                 index.end(), cmp);
+    }
+    SECTION("Test stable double sort")
+    {
+        stable_double_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+    }
+    SECTION("Test stable boost index apply sort")
+    {
+        stable_boost_index_apply_sort(values.begin(), values.end(),
+                                      index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable boost index apply sort 2")
+    {
+        stable_boost_index_apply_sort2(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable permutate in place sort")
+    {
+        stable_permutate_in_place_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable parallel sort")
+    {
+        stable_parallel_sort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp);
+    }
+    SECTION("Test cycle apply sort")
+    {
+        cycle_apply_sort(values.begin(), values.end(), index.begin(),
+                         index.end(), cmp);
+    }
+    SECTION("Test sort")
+    {
+        sort(values.begin(), values.end(), index.begin(), index.end(), cmp);
+    }
+    SECTION("Test stable sort")
+    {
+        stable_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+    }
+    SECTION("Test narrow vector pair sort")
+    {
+        narrow_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                index.end(), cmp);
+    }
+    SECTION("Test stable narrow vector pair sort")
+    {
+        stable_narrow_vector_pair_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(), cmp);
+    }
+    SECTION("Test adaptive sort")
+    {
+        adaptive_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      cmp);
+    }
+    SECTION("Test few unique sort")
+    {
+        few_unique_sort(values.begin(), values.end(), index.begin(),
+                        index.end(), cmp);
+    }
+    SECTION("Test stable few unique sort")
+    {
+        stable_few_unique_sort(values.begin(), values.end(), index.begin(),
+                               index.end(), cmp);
+    }
+    SECTION("Test work stealing sort")
+    {
+        work_stealing_sort(values.begin(), values.end(), index.begin(),
+                           index.end(), cmp);
+    }
+    SECTION("Test stable work stealing sort")
+    {
+        stable_work_stealing_sort(values.begin(), values.end(), index.begin(),
+                                  index.end(), cmp);
+    }
+
+    REQUIRE(values.empty());
+    REQUIRE(index.empty());
+}
+
+TEST_CASE("Test sorting container with invalid length of index")
+{
+    std::vector<int> values({7, 45, 18, 33, 77, 96, 83, 80, 4, 51});
+
+    auto cmp = std::less<int>();
+
+    using iterator_type = decltype(values)::iterator;
+    void (*function)(iterator_type, iterator_type, iterator_type, iterator_type,
+                     std::less<int>);
+
+    SECTION("Test vector pair sort 2")
+    {
+        function =
+          vector_pair_sort2<decltype(values)::iterator,
+                            decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test double sort")
+    {
+        function = double_sort<decltype(values)::iterator,
+                               decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test boost index apply sort")
+    {
+        function =
+          boost_index_apply_sort<decltype(values)::iterator,
+                                 decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test boost index apply sort 2")
+    {
+        function =
+          boost_index_apply_sort2<decltype(values)::iterator,
+                                  decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test permutate in place sort")
+    {
+        function =
+          permutate_in_place_sort<decltype(values)::iterator,
+                                  decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test radix sort")
+    {
+        function = radix_sort<decltype(values)::iterator,
+                              decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test parallel sort")
+    {
+        function = parallel_sort<decltype(values)::iterator,
+                                 decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test packed sort")
+    {
+        function = packed_sort<decltype(values)::iterator,
+                               decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test branchless quick sort")
+    {
+        function = branchless_quick_sort<decltype(values)::iterator,
+                                         decltype(values)::iterator,
+                                         std::less<int>>;
+    }
+    SECTION("Test stable vector pair sort")
+    {
+        function = stable_vector_pair_sort<decltype(values)::iterator,
+                                           decltype(values)::iterator,
+                                           std::less<int>>;
+    }
+    SECTION("Test stable vector pair sort 2")
+    {
+        function = stable_vector_pair_sort2<decltype(values)::iterator,
+                                            decltype(values)::iterator,
+                                            std::less<int>>;
+    }
+    SECTION("Test stable double sort")
+    {
+        function = stable_double_sort<decltype(values)::iterator,
+                                      decltype(values)::iterator,
+                                      std::less<int>>;
+    }
+    SECTION("Test stable boost index apply sort")
+    {
+        function = stable_boost_index_apply_sort<decltype(values)::iterator,
+                                                 decltype(values)::iterator,
+                                                 std::less<int>>;
+    }
+    SECTION("Test stable boost index apply sort 2")
+    {
+        function = stable_boost_index_apply_sort2<decltype(values)::iterator,
+                                                  decltype(values)::iterator,
+                                                  std::less<int>>;
+    }
+    SECTION("Test stable permutate in place sort")
+    {
+        function = stable_permutate_in_place_sort<decltype(values)::iterator,
+                                                  decltype(values)::iterator,
+                                                  std::less<int>>;
+    }
+    SECTION("Test stable parallel sort")
+    {
+        function = stable_parallel_sort<decltype(values)::iterator,
+                                        decltype(values)::iterator,
+                                        std::less<int>>;
+    }
+    SECTION("Test cycle apply sort")
+    {
+        function = cycle_apply_sort<decltype(values)::iterator,
+                                    decltype(values)::iterator,
+                                    std::less<int>>;
+    }
+    SECTION("Test sort")
+    {
+        function = sort<decltype(values)::iterator, decltype(values)::iterator,
+                        std::less<int>>;
+    }
+    SECTION("Test stable sort")
+    {
+        function = stable_sort<decltype(values)::iterator,
+                               decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test narrow vector pair sort")
+    {
+        function = narrow_vector_pair_sort<decltype(values)::iterator,
+                                           decltype(values)::iterator,
+                                           std::less<int>>;
+    }
+    SECTION("Test stable narrow vector pair sort")
+    {
+        function = stable_narrow_vector_pair_sort<decltype(values)::iterator,
+                                                  decltype(values)::iterator,
+                                                  std::less<int>>;
+    }
+    SECTION("Test adaptive sort")
+    {
+        function = adaptive_sort<decltype(values)::iterator,
+                                 decltype(values)::iterator, std::less<int>>;
+    }
+    SECTION("Test work stealing sort")
+    {
+        function = work_stealing_sort<decltype(values)::iterator,
+                                      decltype(values)::iterator,
+                                      std::less<int>>;
+    }
+    SECTION("Test stable work stealing sort")
+    {
+        function = stable_work_stealing_sort<decltype(values)::iterator,
+                                             decltype(values)::iterator,
+                                             std::less<int>>;
+    }
+
+    std::vector<int> index_too_large({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+    try
+    {
+        function(values.begin(), values.end(), index_too_large.begin(),
+                 index_too_large.end(), cmp);
+        FAIL(
+          "Test with too large index: function didn't throw "
+          "indexsort::length_mismatch_error.");
+    }
+    catch (indexsort::length_mismatch_error &)
+    {
+    }
+
+    std::vector<int> index_too_small({0, 1, 2, 3, 4, 5, 6, 7, 8});
+    try
+    {
+        function(values.begin(), values.end(), index_too_small.begin(),
+                 index_too_small.end(), cmp);
+        FAIL(
+          "Test with too small index: function didn't throw "
+          "indexsort::length_mismatch_error.");
+    }
+    catch (indexsort::length_mismatch_error &)
+    {
+    }
+
+    std::vector<int> index_empty({0, 1, 2, 3, 4, 5, 6, 7, 8});
+    try
+    {
+        function(values.begin(), values.end(), index_empty.begin(),
+                 index_empty.end(), cmp);
+        FAIL(
+          "Test with empty index: function didn't throw "
+          "indexsort::length_mismatch_error.");
+    }
+    catch (indexsort::length_mismatch_error &)
+    {
+    }
+}
+
+TEST_CASE("Test narrow vector pair sort with wide index types")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Lengths around the limit of 16-bit indexes.
+    for (std::size_t vector_length : {65535, 65536, 70000})
+    {
+        std::vector<double> values_orig(vector_length);
+        std::uniform_real_distribution<> distrib(-1000.0, 1000.0);
+        std::generate(values_orig.begin(), values_orig.end(),
+                      [&gen, &distrib]() { return distrib(gen); });
+
+        auto check_values(values_orig);
+        std::vector<std::uint64_t> check_index(vector_length);
+        stable_vector_pair_sort(check_values.begin(), check_values.end(),
+                                check_index.begin(), check_index.end(),
+                                std::less<double>());
+
+        auto values(values_orig);
+        std::vector<std::uint64_t> index(vector_length);
+        stable_narrow_vector_pair_sort(values.begin(), values.end(),
+                                       index.begin(), index.end(),
+                                       std::less<double>());
+
+        REQUIRE(values == check_values);
+        REQUIRE(index == check_index);
+
+        values = values_orig;
+        std::vector<std::size_t> size_index(vector_length);
+        narrow_vector_pair_sort(values.begin(), values.end(),
+                                size_index.begin(), size_index.end(),
+                                std::less<double>());
+
+        REQUIRE(values == check_values);
+        for (std::size_t i = 0; i < vector_length; ++i)
+            REQUIRE(values_orig[size_index[i]] == values[i]);
+    }
+}
+
+TEST_CASE("Test append sort")
+{
+    constexpr int vector_length = 2000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Few distinct values, so that stability is observable.
+    std::vector<int> random_values(vector_length);
+    std::uniform_int_distribution<> distrib(0, 99);
+    std::generate(random_values.begin(), random_values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    bool stable = false;
+
+    SECTION("Test append sort")
+    {
+    }
+    SECTION("Test stable append sort")
+    {
+        stable = true;
+    }
+
+    // Base lengths and tails which are unsorted, sorted, going after the base
+    // and going before the base.
+    for (int base_length : {0, vector_length / 2, vector_length - 10,
+                            vector_length})
+    {
+        for (int tail_order = 0; tail_order < 4; ++tail_order)
+        {
+            auto values(random_values);
+            if (tail_order == 1)
+                std::sort(values.begin() + base_length, values.end());
+            if (tail_order == 2)
+                std::sort(values.begin(), values.end());
+            if (tail_order == 3)
+                std::sort(values.begin(), values.end(), std::greater<int>());
+
+            const auto values_orig(values);
+
+            std::vector<int> index(vector_length);
+            std::iota(index.begin(), index.end(), 0);
+
+            auto check_values(values);
+            auto check_index(index);
+            stable_vector_pair_sort(check_values.begin(), check_values.end(),
+                                    check_index.begin(), check_index.end(),
+                                    std::less<int>());
+
+            // Sort the base, then append the unsorted tail to it.
+            stable_vector_pair_sort(
+              values.begin(), values.begin() + base_length, index.begin(),
+              index.begin() + base_length, std::less<int>());
+
+            if (stable)
+                stable_append_sort(values.begin(), values.begin() + base_length,
+                                   values.end(), index.begin(), index.end(),
+                                   std::less<int>());
+            else
+                append_sort(values.begin(), values.begin() + base_length,
+                            values.end(), index.begin(), index.end(),
+                            std::less<int>());
+
+            REQUIRE(values == check_values);
+            REQUIRE(std::is_permutation(index.begin(), index.end(),
+                                        check_index.begin()));
+            for (int i = 0; i < vector_length; ++i)
+                REQUIRE(values[i] == values_orig[index[i]]);
+            if (stable)
+                REQUIRE(index == check_index);
+        }
+    }
+
+    std::vector<int> index_too_small(vector_length - 1);
+    REQUIRE_THROWS_AS(append_sort(random_values.begin(),
+                                  random_values.begin() + 10,
+                                  random_values.end(), index_too_small.begin(),
+                                  index_too_small.end(), std::less<int>()),
+                      indexsort::length_mismatch_error);
+}
+
+TEST_CASE("Test adaptive sort of presorted values")
+{
+    constexpr int vector_length = 5000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Few distinct values, so that stability is observable.
+    std::vector<int> values(vector_length);
+    std::uniform_int_distribution<> distrib(0, 999);
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    SECTION("Test sorted values")
+    {
+        std::sort(values.begin(), values.end());
+    }
+    SECTION("Test reversed values")
+    {
+        std::sort(values.begin(), values.end(), std::greater<int>());
+    }
+    SECTION("Test strictly descending values")
+    {
+        std::iota(values.rbegin(), values.rend(), 0);
+    }
+    SECTION("Test equal values")
+    {
+        std::fill(values.begin(), values.end(), 7);
+    }
+    SECTION("Test sawtooth values")
+    {
+        for (int i = 0; i < vector_length; ++i)
+            values[i] = i % 100;
+    }
+    SECTION("Test few sorted and reversed runs")
+    {
+        std::sort(values.begin(), values.begin() + 1000);
+        std::sort(values.begin() + 1000, values.begin() + 3000,
+                  std::greater<int>());
+        std::sort(values.begin() + 3000, values.end());
+    }
+    SECTION("Test nearly sorted values")
+    {
+        std::sort(values.begin(), values.end());
+        std::uniform_int_distribution<> position(0, vector_length - 1);
+        for (int i = 0; i < 50; ++i)
+            std::swap(values[position(gen)], values[position(gen)]);
+    }
+
+    std::vector<int> index(vector_length);
+    std::iota(index.begin(), index.end(), 0);
+
+    auto check_values(values);
+    auto check_index(index);
+    stable_vector_pair_sort(check_values.begin(), check_values.end(),
+                            check_index.begin(), check_index.end(),
+                            std::less<int>());
+
+    adaptive_sort(values.begin(), values.end(), index.begin(), index.end(),
+                  std::less<int>());
+
+    REQUIRE(values == check_values);
+    REQUIRE(index == check_index);
+}
+
+TEST_CASE("Test string sort")
+{
+    constexpr int vector_length = 5000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Few characters and lengths around multiples of the 8 cached bytes, so
+    // that prefixes are often equal and strings end at every offset within
+    // them.
+    std::uniform_int_distribution<> length_distrib(0, 26);
+    std::uniform_int_distribution<> char_distrib('a', 'c');
+
+    std::vector<std::string> values(vector_length);
+    for (auto & value : values)
+    {
+        value.resize(length_distrib(gen));
+        for (auto & c : value)
+            c = static_cast<char>(char_distrib(gen));
+    }
+
+    SECTION("Test short random strings") {}
+    SECTION("Test strings with a long common prefix")
+    {
+        for (auto & value : values)
+            value = "2026-10-17 12:00:00 server-01 GET /api/" + value;
+    }
+    SECTION("Test strings with zero and high bytes")
+    {
+        for (auto & value : values)
+            for (auto & c : value)
+                c = c == 'a' ? '\0' : c == 'b' ? '\xff' : c;
+    }
+    SECTION("Test equal strings")
+    {
+        std::fill(values.begin(), values.end(), "equal strings");
+    }
+    SECTION("Test sorted strings")
+    {
+        std::sort(values.begin(), values.end());
+    }
+
+    for (bool stable : {false, true})
+    {
+        for (bool descending : {false, true})
+        {
+            auto sorted_values(values);
+            std::vector<int> index(vector_length);
+            std::iota(index.begin(), index.end(), 0);
+
+            auto check_values(values);
+            auto check_index(index);
+
+            if (descending)
+            {
+                stable_vector_pair_sort(check_values.begin(),
+                                        check_values.end(),
+                                        check_index.begin(), check_index.end(),
+                                        std::greater<std::string>());
+                if (stable)
+                    stable_string_sort(sorted_values.begin(),
+                                       sorted_values.end(), index.begin(),
+                                       index.end(), std::greater<>());
+                else
+                    string_sort(sorted_values.begin(), sorted_values.end(),
+                                index.begin(), index.end(),
+                                std::greater<std::string>());
+            }
+            else
+            {
+                stable_vector_pair_sort(check_values.begin(),
+                                        check_values.end(),
+                                        check_index.begin(), check_index.end(),
+                                        std::less<std::string>());
+                if (stable)
+                    stable_string_sort(sorted_values.begin(),
+                                       sorted_values.end(), index.begin(),
+                                       index.end(), std::less<std::string>());
+                else
+                    string_sort(sorted_values.begin(), sorted_values.end(),
+                                index.begin(), index.end(), std::less<>());
+            }
+
+            REQUIRE(sorted_values == check_values);
+            if (stable)
+                REQUIRE(index == check_index);
+            for (int i = 0; i < vector_length; ++i)
+                REQUIRE(sorted_values[i] == values[index[i]]);
+        }
+    }
+}
+
+TEST_CASE("Test string sort of string views")
+{
+    std::vector<std::string_view> values(
+      {"pear", "apple", "", "apple pie", "apples", "pear", "a", "applesauce"});
+    std::vector<int> index(values.size());
+
+    std::vector<std::string_view> result_values(
+      {"", "a", "apple", "apple pie", "apples", "applesauce", "pear", "pear"});
+    std::vector<int> result_index({2, 6, 1, 3, 4, 7, 0, 5});
+
+    stable_string_sort(values.begin(), values.end(), index.begin(),
+                       index.end(), std::less<std::string_view>());
+
+    REQUIRE(values == result_values);
+    REQUIRE(index == result_index);
+
+    std::vector<int> index_too_small(values.size() - 1);
+    REQUIRE_THROWS_AS(string_sort(values.begin(), values.end(),
+                                  index_too_small.begin(),
+                                  index_too_small.end(), std::less<>()),
+                      indexsort::length_mismatch_error);
+}
+
+TEST_CASE("Test few unique sort of low cardinality values")
+{
+    constexpr int vector_length = 20000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> keys(vector_length);
+    int distinct = 0;
+
+    SECTION("Test few distinct values")
+    {
+        // Counting sort.
+        distinct = 10;
+    }
+    SECTION("Test few distinct values and rare outliers")
+    {
+        // Outliers are missing from the sample, counting sort gives up.
+        distinct = 100;
+    }
+    SECTION("Test many duplicates")
+    {
+        // Three-way quicksort.
+        distinct = 300;
+    }
+    SECTION("Test distinct values")
+    {
+        distinct = vector_length * 100;
+    }
+
+    std::uniform_int_distribution<> distrib(0, distinct - 1);
+    std::generate(keys.begin(), keys.end(),
+                  [&gen, &distrib]() { return distrib(gen) * 3; });
+    if (distinct == 100)
+        for (int i = 1; i < vector_length; i += 997)
+            keys[i] = i * 3 + 1;
+
+    auto check_keys(keys);
+    std::vector<int> check_index(vector_length);
+    stable_vector_pair_sort(check_keys.begin(), check_keys.end(),
+                            check_index.begin(), check_index.end(),
+                            std::less<int>());
+
+    for (bool stable : {false, true})
+    {
+        auto values(keys);
+        std::vector<int> index(vector_length);
+        if (stable)
+            stable_few_unique_sort(values.begin(), values.end(), index.begin(),
+                                   index.end(), std::less<int>());
+        else
+            few_unique_sort(values.begin(), values.end(), index.begin(),
+                            index.end(), std::less<int>());
+
+        REQUIRE(values == check_keys);
+        if (stable)
+            REQUIRE(index == check_index);
+        for (int i = 0; i < vector_length; ++i)
+            REQUIRE(values[i] == keys[index[i]]);
+    }
+
+    // Strings and move-only values with the same keys.
+    std::vector<std::string> strings;
+    std::vector<std::unique_ptr<int>> pointers;
+    for (int key : keys)
+    {
+        strings.push_back(std::to_string(key));
+        pointers.push_back(std::make_unique<int>(key));
+    }
+
+    std::vector<int> index(vector_length);
+    stable_few_unique_sort(
+      pointers.begin(), pointers.end(), index.begin(), index.end(),
+      [](const auto & a, const auto & b) { return *a < *b; });
+    REQUIRE(index == check_index);
+
+    auto check_strings(strings);
+    std::vector<int> check_strings_index(vector_length);
+    stable_vector_pair_sort(check_strings.begin(), check_strings.end(),
+                            check_strings_index.begin(),
+                            check_strings_index.end(),
+                            std::less<std::string>());
+    stable_few_unique_sort(strings.begin(), strings.end(), index.begin(),
+                           index.end(), std::less<std::string>());
+    REQUIRE(strings == check_strings);
+    REQUIRE(index == check_strings_index);
+}
+
+TEST_CASE("Test work stealing sort of skewed values")
+{
+    constexpr int vector_length = 100000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> keys(vector_length);
+
+    SECTION("Test uniform values")
+    {
+        std::uniform_int_distribution<> distrib(0, vector_length);
+        std::generate(keys.begin(), keys.end(),
+                      [&gen, &distrib]() { return distrib(gen); });
+    }
+    SECTION("Test skewed values")
+    {
+        // Most values are small, partitions have very different sizes.
+        std::geometric_distribution<> distrib(0.001);
+        std::generate(keys.begin(), keys.end(),
+                      [&gen, &distrib]() { return distrib(gen); });
+    }
+    SECTION("Test equal values")
+    {
+        std::fill(keys.begin(), keys.end(), 42);
+    }
+    SECTION("Test descending values")
+    {
+        std::iota(keys.rbegin(), keys.rend(), 0);
+    }
+
+    auto check_keys(keys);
+    std::vector<int> check_index(vector_length);
+    stable_vector_pair_sort(check_keys.begin(), check_keys.end(),
+                            check_index.begin(), check_index.end(),
+                            std::less<int>());
+
+    // The pool is reused by every call.
+    work_stealing_pool pool(4);
+
+    for (bool stable : {false, true})
+    {
+        for (int call = 0; call < 2; ++call)
+        {
+            auto values(keys);
+            std::vector<int> index(vector_length);
+            if (stable)
+                stable_work_stealing_sort(values.begin(), values.end(),
+                                          index.begin(), index.end(),
+                                          std::less<int>(), pool);
+            else
+                work_stealing_sort(values.begin(), values.end(), index.begin(),
+                                   index.end(), std::less<int>(), pool);
+
+            REQUIRE(values == check_keys);
+            if (stable)
+                REQUIRE(index == check_index);
+            for (int i = 0; i < vector_length; ++i)
+                REQUIRE(values[i] == keys[index[i]]);
+
+            std::sort(index.begin(), index.end());
+            for (int i = 0; i < vector_length; ++i)
+                REQUIRE(index[i] == i);
+        }
+    }
+}
+
+TEST_CASE("Test work stealing pool")
+{
+    for (unsigned thread_count : {1u, 2u, 5u})
+    {
+        work_stealing_pool pool(thread_count);
+        REQUIRE(pool.thread_count() == thread_count);
+
+        // Every task spawns two smaller ones, like a recursive sort.
+        std::atomic<int> leaves = 0;
+        std::function<void(int)> split = [&pool, &leaves, &split](int depth)
+        {
+            if (depth == 0)
+            {
+                ++leaves;
+                return;
+            }
+            pool.spawn([&split, depth] { split(depth - 1); });
+            split(depth - 1);
+        };
+
+        // The pool is reused by every call.
+        for (int call = 1; call <= 3; ++call)
+        {
+            pool.run([&split] { split(12); });
+            REQUIRE(leaves == call * 4096);
+        }
+
+        // Other tasks still run when one throws.
+        auto throwing = [] { throw std::runtime_error("Task failed"); };
+        REQUIRE_THROWS_AS(pool.run(
+                            [&pool, &split, &throwing]
+                            {
+                                pool.spawn(throwing);
+                                split(10);
+                            }),
+                          std::runtime_error);
+        REQUIRE(leaves == 3 * 4096 + 1024);
+
+        pool.run([&split] { split(10); });
+        REQUIRE(leaves == 3 * 4096 + 2048);
+    }
+}
+
+TEST_CASE("Test partial sorting")
+{
+    constexpr int vector_length = 500;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Initialize values with random numbers.
+    std::vector<int> values(vector_length);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    // Initialize index with sequence.
+    std::vector<int> index(values.size());
+    std::iota(index.begin(), index.end(), 0);
+
+    auto orig_values(values);
+    auto check_values(values);
+    auto check_index(index);
+    vector_pair_sort(check_values.begin(), check_values.end(),
+                     check_index.begin(), check_index.end(), std::less<int>());
+
+    auto cmp = std::less<int>();
+
+    for (int k : {0, 1, 10, 250, 499, 500, 600})
+    {
+        DYNAMIC_SECTION("Test partial index sort with k = " << k)
+        {
+            partial_index_sort(values.begin(), values.end(), index.begin(),
+                               index.end(), k, cmp);
+
+            int sorted = std::min(k, vector_length);
+            REQUIRE(std::equal(values.begin(), values.begin() + sorted,
+                               check_values.begin()));
+            REQUIRE(std::equal(index.begin(), index.begin() + sorted,
+                               check_index.begin()));
+
+            // The rest of the index must still describe the values.
+            std::vector<int> described_values;
+            for (int i : index)
+                described_values.push_back(orig_values[i]);
+            REQUIRE(values == described_values);
+
+            auto sorted_index(index);
+            std::sort(sorted_index.begin(), sorted_index.end());
+            REQUIRE(std::adjacent_find(sorted_index.begin(),
+                                       sorted_index.end()) ==
+                    sorted_index.end());
+        }
+    }
+
+    SECTION("Test partial index sort with invalid length of index")
+    {
+        std::vector<int> index_too_small(vector_length - 1);
+        REQUIRE_THROWS_AS(
+          partial_index_sort(values.begin(), values.end(),
+                             index_too_small.begin(), index_too_small.end(),
+                             10, cmp),
+          indexsort::length_mismatch_error);
+    }
+}
+
+TEST_CASE("Test argsort")
+{
+    constexpr int vector_length = 500;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Initialize values with random numbers. Values are const, argsort must
+    // not move them.
+    std::vector<int> values_init(vector_length);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    std::generate(values_init.begin(), values_init.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    const std::vector<int> values(values_init);
+
+    // Initialize index with sequence.
+    std::vector<int> index(values.size());
+    std::iota(index.begin(), index.end(), 0);
+
+    auto check_values(values);
+    auto check_index(index);
+    vector_pair_sort(check_values.begin(), check_values.end(),
+                     check_index.begin(), check_index.end(), std::less<int>());
+
+    std::vector<int> index_too_small(vector_length - 1);
+    REQUIRE_THROWS_AS(argsort(values.begin(), values.end(),
+                              index_too_small.begin(), index_too_small.end(),
+                              std::less<int>()),
+                      indexsort::length_mismatch_error);
+
+    SECTION("Test argsort of integers")
+    {
+        argsort(values.begin(), values.end(), index.begin(), index.end(),
+                std::less<int>());
+    }
+    SECTION("Test stable argsort of integers")
+    {
+        stable_argsort(values.begin(), values.end(), index.begin(),
+                       index.end(), std::less<int>());
+    }
+    SECTION("Test argsort of pointer range")
+    {
+        argsort(values.data(), values.data() + values.size(), index.begin(),
+                index.end(), std::less<int>());
+    }
+    SECTION("Test argsort with custom comparator")
+    {
+        argsort(values.begin(), values.end(), index.begin(), index.end(),
+                [](int a, int b) { return a < b; });
+    }
+    SECTION("Test argsort of strings")
+    {
+        std::vector<std::string> strings;
+        for (int value : values)
+            strings.push_back(std::to_string(value));
+
+        auto check_strings(strings);
+        check_index = index;
+        vector_pair_sort(check_strings.begin(), check_strings.end(),
+                         check_index.begin(), check_index.end(),
+                         std::less<std::string>());
+
+        const auto strings_copy(strings);
+        argsort(strings.cbegin(), strings.cend(), index.begin(), index.end(),
+                std::less<std::string>());
+
+        REQUIRE(strings == strings_copy);
+    }
+
+    REQUIRE(values == values_init);
+    REQUIRE(index == check_index);
+}
+
+TEST_CASE("Test ranking")
+{
+    std::vector<int> values({7, 45, 7, 33, 45, 4});
+    std::vector<int> ranks(values.size());
+
+    SECTION("Test ordinal ranks")
+    {
+        argrank(values.begin(), values.end(), ranks.begin(), ranks.end(),
+                std::less<int>());
+        REQUIRE(ranks == std::vector<int>({1, 4, 2, 3, 5, 0}));
+    }
+    SECTION("Test min ranks")
+    {
+        argrank(values.begin(), values.end(), ranks.begin(), ranks.end(),
+                std::less<int>(), rank_mode::min);
+        REQUIRE(ranks == std::vector<int>({1, 4, 1, 3, 4, 0}));
+    }
+    SECTION("Test dense ranks")
+    {
+        argrank(values.begin(), values.end(), ranks.begin(), ranks.end(),
+                std::less<int>(), rank_mode::dense);
+        REQUIRE(ranks == std::vector<int>({1, 3, 1, 2, 3, 0}));
+    }
+    SECTION("Test dense ranks in descending order")
+    {
+        argrank(values.begin(), values.end(), ranks.begin(), ranks.end(),
+                std::greater<int>(), rank_mode::dense);
+        REQUIRE(ranks == std::vector<int>({2, 0, 2, 1, 0, 3}));
+    }
+    SECTION("Test ordinal ranks of negative and positive zeros")
+    {
+        // -0.0 and 0.0 are equal, so they are ranked by their position.
+        std::vector<double> zeros({0.0, -0.0});
+        std::vector<int> zero_ranks(zeros.size());
+        argrank(zeros.begin(), zeros.end(), zero_ranks.begin(),
+                zero_ranks.end(), std::less<double>());
+        REQUIRE(zero_ranks == std::vector<int>({0, 1}));
+    }
+    SECTION("Test ranks of empty containers")
+    {
+        values.clear();
+        ranks.clear();
+        argrank(values.begin(), values.end(), ranks.begin(), ranks.end(),
+                std::less<int>(), rank_mode::dense);
+        REQUIRE(ranks.empty());
+    }
+
+    std::vector<int> ranks_too_small(values.size() + 1);
+    REQUIRE_THROWS_AS(argrank(values.begin(), values.end(),
+                              ranks_too_small.begin(), ranks_too_small.end(),
+                              std::less<int>()),
+                      indexsort::length_mismatch_error);
+}
+
+TEST_CASE("Test ranking random values")
+{
+    constexpr int vector_length = 2000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Few distinct values, so that there are many ties.
+    std::vector<int> values_int(vector_length);
+    std::uniform_int_distribution<> distrib(0, 99);
+    std::generate(values_int.begin(), values_int.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    std::vector<std::string> values_string;
+    for (int value : values_int)
+        values_string.push_back(std::to_string(value));
+
+    auto check = [](auto values, auto cmp, rank_mode mode)
+    {
+        std::vector<int> check_index(values.size());
+        auto check_values(values);
+        stable_vector_pair_sort(check_values.begin(), check_values.end(),
+                                check_index.begin(), check_index.end(), cmp);
+
+        // Ranks computed by inverting the index.
+        std::vector<int> check_ranks(values.size());
+        int shared = 0;
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            bool tied = i != 0 && !cmp(check_values[i - 1], check_values[i]);
+            if (mode == rank_mode::ordinal || (mode == rank_mode::min && !tied))
+                shared = static_cast<int>(i);
+            else if (mode == rank_mode::dense && !tied && i != 0)
+                ++shared;
+            check_ranks[check_index[i]] = shared;
+        }
+
+        std::vector<int> ranks(values.size());
+        argrank(values.cbegin(), values.cend(), ranks.begin(), ranks.end(),
+                cmp, mode);
+        REQUIRE(ranks == check_ranks);
+
+        std::vector<int> index(values.size());
+        std::fill(ranks.begin(), ranks.end(), -1);
+        rank_sort(values.begin(), values.end(), index.begin(), index.end(),
+                  ranks.begin(), ranks.end(), cmp, mode);
+        REQUIRE(values == check_values);
+        REQUIRE(index == check_index);
+        REQUIRE(ranks == check_ranks);
+    };
+
+    for (auto mode : {rank_mode::ordinal, rank_mode::min, rank_mode::dense})
+    {
+        check(values_int, std::less<int>(), mode);
+        check(values_int, std::greater<int>(), mode);
+        check(values_int, [](int a, int b) { return a / 10 < b / 10; }, mode);
+        check(values_string, std::less<std::string>(), mode);
+    }
+}
+
+TEST_CASE("Test applying permutation")
+{
+    constexpr int vector_length = 500;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> index(vector_length);
+    std::iota(index.begin(), index.end(), 0);
+
+    SECTION("Identity permutation")
+    {
+    }
+    SECTION("Reversed permutation")
+    {
+        std::reverse(index.begin(), index.end());
+    }
+    SECTION("Random permutation")
+    {
+        std::shuffle(index.begin(), index.end(), gen);
+    }
+
+    const auto index_copy(index);
+
+    std::vector<int> values(vector_length);
+    std::iota(values.begin(), values.end(), 1000);
+
+    std::vector<int> check_values;
+    for (int i : index)
+        check_values.push_back(values[i]);
+
+    apply_permutation(values.begin(), values.end(), index.begin(), index.end());
+
+    REQUIRE(values == check_values);
+    REQUIRE(index == index_copy);
+
+    // Move-only values.
+    std::vector<std::unique_ptr<int>> pointers;
+    for (int i = 0; i < vector_length; ++i)
+        pointers.push_back(std::make_unique<int>(i + 1000));
+
+    apply_permutation(pointers.begin(), pointers.end(), index.begin(),
+                      index.end());
+
+    std::vector<int> pointed_values;
+    for (const auto & pointer : pointers)
+        pointed_values.push_back(*pointer);
+    REQUIRE(pointed_values == check_values);
+
+    std::vector<int> index_too_small(vector_length - 1);
+    REQUIRE_THROWS_AS(apply_permutation(values.begin(), values.end(),
+                                        index_too_small.begin(),
+                                        index_too_small.end()),
+                      indexsort::length_mismatch_error);
+}
+
+TEST_CASE("Test applying permutation to many ranges")
+{
+    constexpr int vector_length = 5000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> index(vector_length);
+    std::iota(index.begin(), index.end(), 0);
+    std::shuffle(index.begin(), index.end(), gen);
+
+    const auto index_copy(index);
+
+    std::vector<int> ints(vector_length);
+    std::iota(ints.begin(), ints.end(), 1000);
+
+    std::vector<std::string> strings;
+    std::vector<std::unique_ptr<int>> pointers;
+    for (int value : ints)
+    {
+        strings.push_back(std::to_string(value));
+        pointers.push_back(std::make_unique<int>(value));
+    }
+
+    std::vector<int> check_ints;
+    for (int i : index)
+        check_ints.push_back(ints[i]);
+
+    auto check_strings = [&check_ints](const std::vector<std::string> & s)
+    {
+        for (int i = 0; i < vector_length; ++i)
+            REQUIRE(s[i] == std::to_string(check_ints[i]));
+    };
+    auto check_all = [&]()
+    {
+        REQUIRE(index == index_copy);
+        REQUIRE(ints == check_ints);
+        check_strings(strings);
+        for (int i = 0; i < vector_length; ++i)
+            REQUIRE(*pointers[i] == check_ints[i]);
+    };
+
+    SECTION("Test ranges of different types")
+    {
+        apply_permutation_batch(
+          index.begin(), index.end(), std::make_pair(ints.begin(), ints.end()),
+          std::make_pair(strings.begin(), strings.end()),
+          std::make_pair(pointers.begin(), pointers.end()));
+        check_all();
+    }
+    SECTION("Test ranges of different types in parallel")
+    {
+        parallel_apply_permutation_batch(
+          index.begin(), index.end(), std::make_pair(ints.begin(), ints.end()),
+          std::make_pair(strings.begin(), strings.end()),
+          std::make_pair(pointers.begin(), pointers.end()), 2);
+        check_all();
+    }
+    SECTION("Test more threads than ranges")
+    {
+        parallel_apply_permutation_batch(
+          index.begin(), index.end(), std::make_pair(ints.begin(), ints.end()),
+          std::make_pair(strings.begin(), strings.end()),
+          std::make_pair(pointers.begin(), pointers.end()), 8);
+        check_all();
+    }
+
+    SECTION("Test list of ranges")
+    {
+        std::vector<std::vector<std::string>> columns;
+        using range = std::pair<std::vector<std::string>::iterator,
+                                std::vector<std::string>::iterator>;
+
+        for (unsigned thread_count : {1, 3, 16})
+        {
+            columns.assign(10, strings);
+
+            std::vector<range> ranges;
+            for (auto & column : columns)
+                ranges.emplace_back(column.begin(), column.end());
+
+            apply_permutation_batch(index.begin(), index.end(), ranges,
+                                    thread_count);
+
+            for (const auto & column : columns)
+                check_strings(column);
+        }
+        REQUIRE(index == index_copy);
+
+        std::vector<range> no_ranges;
+        apply_permutation_batch(index.begin(), index.end(), no_ranges);
+    }
+    SECTION("Test ranges of invalid length")
+    {
+        std::vector<int> too_small(vector_length - 1);
+        REQUIRE_THROWS_AS(
+          apply_permutation_batch(
+            index.begin(), index.end(),
+            std::make_pair(ints.begin(), ints.end()),
+            std::make_pair(too_small.begin(), too_small.end())),
+          indexsort::length_mismatch_error);
+        REQUIRE_THROWS_AS(
+          apply_permutation_batch(
+            index.begin(), index.end(),
+            std::vector{std::make_pair(too_small.begin(), too_small.end())}),
+          indexsort::length_mismatch_error);
+    }
+}
+
+TEST_CASE("Test multi-key sorting")
+{
+    constexpr int vector_length = 2000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Few distinct values in every column, so that rows are often tied in the
+    // first columns and sometimes in all of them.
+    std::uniform_int_distribution<> distrib(0, 9);
+
+    std::vector<int> years(vector_length);
+    std::vector<double> scores(vector_length);
+    std::vector<std::string> names(vector_length);
+    for (int i = 0; i < vector_length; ++i)
+    {
+        years[i] = 2000 + distrib(gen);
+        scores[i] = distrib(gen) / 2.0;
+        names[i] = std::string(1, static_cast<char>('a' + distrib(gen)));
+    }
+
+    // Years ascending, scores descending, names ascending and original
+    // position for full ties.
+    std::vector<int> check_index(vector_length);
+    std::iota(check_index.begin(), check_index.end(), 0);
+    std::stable_sort(check_index.begin(), check_index.end(),
+                     [&](int a, int b)
+                     {
+                         return std::make_tuple(years[a], -scores[a],
+                                                names[a]) <
+                                std::make_tuple(years[b], -scores[b],
+                                                names[b]);
+                     });
+
+    std::vector<int> index(vector_length);
+    std::iota(index.begin(), index.end(), 0);
+
+    SECTION("Test multi-key argsort")
+    {
+        const auto years_copy(years);
+        const auto scores_copy(scores);
+        const auto names_copy(names);
+
+        multi_key_argsort(
+          index.begin(), index.end(), column(years.cbegin(), years.cend()),
+          column(scores.cbegin(), scores.cend(), sort_direction::descending),
+          column(names.cbegin(), names.cend()));
+
+        REQUIRE(index == check_index);
+        REQUIRE(years == years_copy);
+        REQUIRE(scores == scores_copy);
+        REQUIRE(names == names_copy);
+    }
+    SECTION("Test multi-key sort applying permutation to all columns")
+    {
+        std::vector<int> check_years;
+        std::vector<double> check_scores;
+        std::vector<std::string> check_names;
+        for (int i : check_index)
+        {
+            check_years.push_back(years[i]);
+            check_scores.push_back(scores[i]);
+            check_names.push_back(names[i]);
+        }
+
+        multi_key_sort(
+          index.begin(), index.end(), column(years.begin(), years.end()),
+          column(scores.begin(), scores.end(), sort_direction::descending),
+          column(names.begin(), names.end()));
+
+        REQUIRE(index == check_index);
+        REQUIRE(years == check_years);
+        REQUIRE(scores == check_scores);
+        REQUIRE(names == check_names);
+    }
+    SECTION("Test multi-key argsort of single column")
+    {
+        multi_key_argsort(index.begin(), index.end(),
+                          column(years.cbegin(), years.cend(),
+                                 sort_direction::descending));
+
+        check_index = std::vector<int>(vector_length);
+        std::iota(check_index.begin(), check_index.end(), 0);
+        std::stable_sort(check_index.begin(), check_index.end(),
+                         [&](int a, int b) { return years[a] > years[b]; });
+
+        REQUIRE(index == check_index);
+    }
+    SECTION("Test multi-key argsort with column of invalid length")
+    {
+        std::vector<int> column_too_small(vector_length - 1);
+        REQUIRE_THROWS_AS(
+          multi_key_argsort(index.begin(), index.end(),
+                            column(years.cbegin(), years.cend()),
+                            column(column_too_small.cbegin(),
+                                   column_too_small.cend())),
+          indexsort::length_mismatch_error);
+    }
+}
+
+TEST_CASE("Test sorting with scratch arena")
+{
+    constexpr int vector_length = 500;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Initialize values with random numbers.
+    std::vector<int> values_orig(vector_length);
+
+    using limits = std::numeric_limits<int>;
+    std::uniform_int_distribution<> distrib(limits::min(), limits::max());
+
+    std::generate(values_orig.begin(), values_orig.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    // Initialize index with sequence.
+    std::vector<int> index_orig(values_orig.size());
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto check_values(values_orig);
+    auto check_index(index_orig);
+    vector_pair_sort(check_values.begin(), check_values.end(),
+                     check_index.begin(), check_index.end(), std::less<int>());
+
+    auto cmp = std::less<int>();
+
+    scratch_arena arena;
+    arena_allocator<int> alloc(arena);
+
+    // The first sort measures the buffers, the second one grows the arena
+    // and the third one must fit into it.
+    auto run_three_times = [&](auto sort)
+    {
+        for (int call = 0; call < 3; ++call)
+        {
+            auto values(values_orig);
+            auto index(index_orig);
+            auto capacity = arena.capacity();
+            sort(values, index);
+
+            REQUIRE(values == check_values);
+            REQUIRE(index == check_index);
+            if (call == 0)
+                REQUIRE(arena.capacity() == 0);
+            if (call == 1)
+                REQUIRE(arena.capacity() > 0);
+            if (call == 2)
+                REQUIRE(arena.capacity() == capacity);
+        }
+    };
+
+    SECTION("Test vector pair sort with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            vector_pair_sort(values.begin(), values.end(), index.begin(),
+                             index.end(), cmp, alloc);
+        };
+        run_three_times(sort);
+    }
+    SECTION("Test stable vector pair sort with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            stable_vector_pair_sort(values.begin(), values.end(), index.begin(),
+                                    index.end(), cmp, alloc);
+        };
+        run_three_times(sort);
+    }
+    SECTION("Test vector pair sort 2 with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            vector_pair_sort2(values.begin(), values.end(), index.begin(),
+                              index.end(), cmp, alloc);
+        };
+        run_three_times(sort);
+    }
+    SECTION("Test stable vector pair sort 2 with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            stable_vector_pair_sort2(values.begin(), values.end(),
+                                     index.begin(), index.end(), cmp, alloc);
+        };
+        run_three_times(sort);
+    }
+    SECTION("Test boost index apply sort with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            boost_index_apply_sort(values.begin(), values.end(), index.begin(),
+                                   index.end(), cmp, alloc);
+        };
+        run_three_times(sort);
+    }
+    SECTION("Test stable boost index apply sort with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            stable_boost_index_apply_sort(values.begin(), values.end(),
+                                          index.begin(), index.end(), cmp,
+                                          alloc);
+        };
+        run_three_times(sort);
+    }
+    SECTION("Test boost index apply sort 2 with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            boost_index_apply_sort2(values.begin(), values.end(), index.begin(),
+                                    index.end(), cmp, alloc);
+        };
+        run_three_times(sort);
+    }
+    SECTION("Test stable boost index apply sort 2 with scratch arena")
+    {
+        auto sort = [&cmp, &alloc](auto & values, auto & index)
+        {
+            stable_boost_index_apply_sort2(values.begin(), values.end(),
+                                           index.begin(), index.end(), cmp,
+                                           alloc);
+        };
+        run_three_times(sort);
+    }
+}
+
+TEST_CASE("Test sort dispatcher around its thresholds")
+{
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Few distinct keys, so that stability is observable.
+    std::uniform_int_distribution<> distrib(0, 99);
+
+    struct large_value
+    {
+        int key;
+        std::array<char, 100> payload;
+    };
+
+    // Sort values with both sort() and stable_sort() and check them against
+    // std::stable_sort of an index of the type of index_type.
+    auto check = [](const auto & values_orig, auto cmp, auto index_type)
+    {
+        using index_val_type = decltype(index_type);
+
+        std::vector<index_val_type> index_orig(values_orig.size());
+        std::iota(index_orig.begin(), index_orig.end(), 0);
+
+        auto check_index(index_orig);
+        std::stable_sort(check_index.begin(), check_index.end(),
+                         [&values_orig, &cmp](index_val_type a,
+                                              index_val_type b)
+                         { return cmp(values_orig[a], values_orig[b]); });
+
+        auto values(values_orig);
+        auto index(index_orig);
+        stable_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    cmp);
+        REQUIRE(index == check_index);
+        for (std::size_t i = 0; i < values.size(); ++i)
+            REQUIRE(!cmp(values[i], values_orig[index[i]]));
+
+        values = values_orig;
+        index = index_orig;
+        sort(values.begin(), values.end(), index.begin(), index.end(), cmp);
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            REQUIRE(!cmp(values[i], values_orig[check_index[i]]));
+            REQUIRE(!cmp(values_orig[check_index[i]], values[i]));
+            REQUIRE(!cmp(values[i], values_orig[index[i]]));
+            REQUIRE(!cmp(values_orig[index[i]], values[i]));
+        }
+    };
+
+    for (int length : {10, 1023, 1024, 5000})
+    {
+        DYNAMIC_SECTION("Test integers with length " << length)
+        {
+            std::vector<int> values(length);
+            for (auto & value : values)
+                value = distrib(gen);
+
+            check(values, std::less<int>(), 0);
+        }
+        DYNAMIC_SECTION("Test doubles in descending order with length "
+                        << length)
+        {
+            std::vector<double> values(length);
+            for (auto & value : values)
+                value = distrib(gen) - 49.5;
+
+            check(values, std::greater<double>(), 0);
+        }
+        DYNAMIC_SECTION("Test custom comparator with length " << length)
+        {
+            std::vector<int> values(length);
+            for (auto & value : values)
+                value = distrib(gen);
+
+            check(values, [](int a, int b) { return a % 10 < b % 10; }, 0);
+        }
+        DYNAMIC_SECTION("Test custom comparator with 64-bit index and length "
+                        << length)
+        {
+            // Pairs with a 32-bit position are smaller, so they are narrowed.
+            std::vector<int> values(length);
+            for (auto & value : values)
+                value = distrib(gen);
+
+            check(values, [](int a, int b) { return a % 10 < b % 10; },
+                  std::int64_t());
+        }
+        DYNAMIC_SECTION("Test large values with length " << length)
+        {
+            std::vector<large_value> values(length);
+            for (auto & value : values)
+                value.key = distrib(gen);
+
+            check(
+              values,
+              [](const large_value & a, const large_value & b)
+              { return a.key < b.key; },
+              0);
+        }
+    }
+}
+
+TEST_CASE("Test sorting network")
+{
+    using namespace indexsort::detail;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937_64 gen(rng_seed);
+
+    // Every instruction set the CPU supports.
+    std::vector<network_isa> isas = {network_isa::scalar};
+    if (detected_network_isa() >= network_isa::avx2)
+        isas.push_back(network_isa::avx2);
+    if (detected_network_isa() >= network_isa::avx512)
+        isas.push_back(network_isa::avx512);
+
+    for (network_isa isa : isas)
+    {
+        DYNAMIC_SECTION("Test sort network with instruction set "
+                        << static_cast<int>(isa))
+        {
+            for (std::size_t length = 0; length <= sorting_network_max_length;
+                 ++length)
+            {
+                // Random elements and elements with many duplicates.
+                for (std::uint64_t range : {std::uint64_t(0), std::uint64_t(4)})
+                {
+                    std::vector<std::uint64_t> values(length);
+                    for (auto & value : values)
+                        value = range ? gen() % range : gen();
+
+                    auto check_values(values);
+                    std::sort(check_values.begin(), check_values.end());
+
+                    sort_network(values.data(), values.size(), isa);
+                    REQUIRE(values == check_values);
+                }
+            }
+        }
+    }
+
+    for (std::size_t length : {1, 64, 65, 1000, 4096})
+    {
+        DYNAMIC_SECTION("Test network merge sort with length " << length)
+        {
+            std::vector<std::uint64_t> values(length);
+            for (auto & value : values)
+                value = gen();
+
+            auto check_values(values);
+            std::sort(check_values.begin(), check_values.end());
+
+            std::vector<std::uint64_t> buffer(length);
+            network_merge_sort(values.data(), buffer.data(), values.size());
+            REQUIRE(values == check_values);
+        }
     }
 }
@@ -0,0 +1,142 @@
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include "external_sort.hpp"
+#include "temporary_file.hpp"
+#include "vector_pair_sort.hpp"
+
+using namespace indexsort;
+
+TEST_CASE("Test external sorting")
+{
+    constexpr int vector_length = 10000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    // Few distinct values, so that stability is observable.
+    std::vector<int> values(vector_length);
+    std::uniform_int_distribution<> distrib(0, 999);
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    auto cmp = std::less<int>();
+
+    auto check_values(values);
+    std::vector<std::uint64_t> check_index(values.size());
+    stable_vector_pair_sort(check_values.begin(), check_values.end(),
+                            check_index.begin(), check_index.end(), cmp);
+
+    temporary_path value_path("values");
+    temporary_path index_path("index");
+
+    // The tiny budgets force many runs and several merge passes.
+    for (std::size_t budget : {1, 64, 1000, 100'000, 1'000'000})
+    {
+        DYNAMIC_SECTION("Test sorting iterator range with budget " << budget)
+        {
+            external_sort(values.cbegin(), values.cend(), value_path.string(),
+                          index_path.string(), cmp, budget);
+
+            REQUIRE(read_file<int>(value_path.string()) == check_values);
+            REQUIRE(read_file<std::uint64_t>(index_path.string()) ==
+                    check_index);
+        }
+    }
+
+    SECTION("Test sorting file")
+    {
+        temporary_path input_path("input");
+        write_file(input_path.string(), values);
+
+        external_sort<int>(input_path.string(), value_path.string(),
+                           index_path.string(), cmp, 1000);
+
+        REQUIRE(read_file<int>(value_path.string()) == check_values);
+        REQUIRE(read_file<std::uint64_t>(index_path.string()) == check_index);
+    }
+}
+
+TEST_CASE("Test external sorting doubles in descending order")
+{
+    constexpr int vector_length = 5000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<double> values(vector_length);
+    std::uniform_real_distribution<> distrib(-1000.0, 1000.0);
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    auto cmp = std::greater<double>();
+
+    auto check_values(values);
+    std::vector<std::uint64_t> check_index(values.size());
+    stable_vector_pair_sort(check_values.begin(), check_values.end(),
+                            check_index.begin(), check_index.end(), cmp);
+
+    temporary_path value_path("values");
+    temporary_path index_path("index");
+
+    external_sort(values.data(), values.data() + values.size(),
+                  value_path.string(), index_path.string(), cmp, 4096);
+
+    REQUIRE(read_file<double>(value_path.string()) == check_values);
+    REQUIRE(read_file<std::uint64_t>(index_path.string()) == check_index);
+}
+
+TEST_CASE("Test external sorting empty input")
+{
+    std::vector<int> values;
+
+    temporary_path value_path("values");
+    temporary_path index_path("index");
+
+    external_sort(values.begin(), values.end(), value_path.string(),
+                  index_path.string(), std::less<int>(), 1000);
+
+    REQUIRE(read_file<int>(value_path.string()).empty());
+    REQUIRE(read_file<std::uint64_t>(index_path.string()).empty());
+}
+
+TEST_CASE("Test external sorting with inaccessible files")
+{
+    std::vector<int> values({3, 1, 2});
+
+    temporary_path value_path("values");
+    temporary_path index_path("index");
+    temporary_path missing_directory("missing");
+
+    auto missing_file = (missing_directory.path / "file").string();
+
+    SECTION("Test missing input file")
+    {
+        REQUIRE_THROWS_AS(external_sort<int>(missing_file, value_path.string(),
+                                             index_path.string(),
+                                             std::less<int>(), 1000),
+                          indexsort::io_error);
+    }
+    SECTION("Test input file ending with a partial value")
+    {
+        temporary_path input_path("input");
+        write_file(input_path.string(), std::vector<char>(2 * sizeof(int) + 1));
+
+        REQUIRE_THROWS_AS(external_sort<int>(input_path.string(),
+                                             value_path.string(),
+                                             index_path.string(),
+                                             std::less<int>(), 1000),
+                          indexsort::io_error);
+    }
+    SECTION("Test unwritable output file")
+    {
+        REQUIRE_THROWS_AS(external_sort(values.begin(), values.end(),
+                                        missing_file, index_path.string(),
+                                        std::less<int>(), 1000),
+                          indexsort::io_error);
+    }
+}
@@ -0,0 +1,291 @@
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "adaptive_sort.hpp"
+#include "boost_index_apply_sort.hpp"
+#include "boost_index_apply_sort2.hpp"
+#include "cycle_apply_sort.hpp"
+#include "double_sort.hpp"
+#include "few_unique_sort.hpp"
+#include "instrumentation.hpp"
+#include "parallel_sort.hpp"
+#include "permutate_in_place_sort.hpp"
+#include "radix_sort.hpp"
+#include "vector_pair_sort.hpp"
+
+#ifndef INDEXSORT_INSTRUMENTATION
+#error "Compile test_instrumentation.cpp with INDEXSORT_INSTRUMENTATION"
+#endif
+
+using namespace indexsort;
+using instrumentation::counted;
+using instrumentation::counted_compare;
+using instrumentation::counted_iterator;
+
+namespace
+{
+std::vector<counted<int>> random_counted_values(std::size_t length)
+{
+    std::mt19937 gen(Catch::getSeed());
+    std::uniform_int_distribution<int> dist(0, 1000);
+
+    std::vector<counted<int>> values;
+    for (std::size_t i = 0; i < length; ++i)
+        values.emplace_back(dist(gen));
+    return values;
+}
+
+bool is_sorted_counted(const std::vector<counted<int>> & values)
+{
+    return std::is_sorted(values.begin(), values.end(),
+                          [](const counted<int> & a, const counted<int> & b)
+                          { return a.value() < b.value(); });
+}
+};  // namespace
+
+TEST_CASE("Test instrumentation counts comparisons", "[instrumentation]")
+{
+    std::vector<int> values({7, 45, 18, 33, 77, 96, 83, 80, 4, 51});
+    auto cmp = counted_compare(std::less<int>());
+
+    instrumentation::reset();
+    std::sort(values.begin(), values.end(), cmp);
+    auto comparisons = instrumentation::current().comparisons;
+
+    REQUIRE(std::is_sorted(values.begin(), values.end()));
+    REQUIRE(comparisons > 0);
+
+    std::sort(values.begin(), values.end(), cmp);
+    REQUIRE(instrumentation::current().comparisons > comparisons);
+
+    instrumentation::reset();
+    REQUIRE(instrumentation::current().comparisons == 0);
+    REQUIRE(instrumentation::current().phases.empty());
+}
+
+TEST_CASE("Test instrumentation of algorithms", "[instrumentation]")
+{
+    constexpr std::size_t length = 1000;
+    auto values = random_counted_values(length);
+    std::vector<int> index(length);
+    std::iota(index.begin(), index.end(), 0);
+    auto cmp = counted_compare(std::less<int>());
+
+    instrumentation::reset();
+    const auto & stats = instrumentation::current();
+
+    SECTION("permutate_in_place_sort")
+    {
+        permutate_in_place_sort(values.begin(), values.end(),
+                                counted_iterator(index.begin()),
+                                counted_iterator(index.end()), cmp);
+
+        REQUIRE(stats.swaps == length);
+        REQUIRE(stats.scratch_bytes == 0);
+    }
+
+    SECTION("cycle_apply_sort")
+    {
+        cycle_apply_sort(values.begin(), values.end(),
+                         counted_iterator(index.begin()),
+                         counted_iterator(index.end()), cmp);
+
+        REQUIRE(stats.moves > 0);
+        REQUIRE(stats.swaps == 0);
+        REQUIRE(stats.scratch_bytes == (length + 63) / 64 * 8);
+    }
+
+    SECTION("boost_index_apply_sort")
+    {
+        boost_index_apply_sort(values.begin(), values.end(),
+                               counted_iterator(index.begin()),
+                               counted_iterator(index.end()), cmp);
+
+        REQUIRE(stats.swaps > 0);
+        REQUIRE(stats.scratch_bytes == length * sizeof(int));
+    }
+
+    SECTION("boost_index_apply_sort2")
+    {
+        boost_index_apply_sort2(values.begin(), values.end(),
+                                counted_iterator(index.begin()),
+                                counted_iterator(index.end()), cmp);
+
+        REQUIRE(stats.swaps > 0);
+        REQUIRE(stats.scratch_bytes == length * sizeof(int));
+    }
+
+    REQUIRE(is_sorted_counted(values));
+    REQUIRE(stats.comparisons > 0);
+    REQUIRE(stats.copies == 0);
+    REQUIRE(stats.index_dereferences > 0);
+
+    REQUIRE(stats.phases.size() == 2);
+    for (const char * name : {"sort", "apply"})
+    {
+        REQUIRE(stats.phases.count(name) == 1);
+        const auto & phase = stats.phases.at(name);
+        REQUIRE(phase.calls == 1);
+        REQUIRE(phase.time.count() >= 0);
+        REQUIRE(phase.cache_misses.has_value() ==
+                phase.branch_misses.has_value());
+    }
+}
+
+TEST_CASE("Test instrumentation of vector pair sort", "[instrumentation]")
+{
+    constexpr std::size_t length = 1000;
+    auto values = random_counted_values(length);
+    std::vector<int> index(length);
+
+    instrumentation::reset();
+    const auto & stats = instrumentation::current();
+
+    vector_pair_sort(values.begin(), values.end(), index.begin(), index.end(),
+                     counted_compare(std::less<int>()));
+
+    REQUIRE(is_sorted_counted(values));
+    REQUIRE(stats.copies == 0);
+    // Every value is moved into a pair and back at least.
+    REQUIRE(stats.moves >= 2 * length);
+    REQUIRE(stats.scratch_bytes ==
+            length * sizeof(std::pair<counted<int>, int>));
+    REQUIRE(stats.phases.count("convert") == 1);
+    REQUIRE(stats.phases.count("sort") == 1);
+    REQUIRE(stats.phases.count("apply") == 1);
+}
+
+TEST_CASE("Test instrumentation of sort and apply phases", "[instrumentation]")
+{
+    constexpr std::size_t length = 1000;
+    std::vector<int> values;
+    for (const auto & value : random_counted_values(length))
+        values.push_back(value.value());
+    std::vector<int> index(length);
+    std::iota(index.begin(), index.end(), 0);
+
+    instrumentation::reset();
+    const auto & stats = instrumentation::current();
+
+    SECTION("double_sort")
+    {
+        double_sort(values.begin(), values.end(), index.begin(), index.end(),
+                    std::less<int>());
+
+        REQUIRE(stats.scratch_bytes == 0);
+    }
+
+    SECTION("radix_sort")
+    {
+        radix_sort(values.begin(), values.end(), index.begin(), index.end(),
+                   std::less<int>());
+
+        REQUIRE(stats.scratch_bytes == 2 * length * 2 * sizeof(int));
+        REQUIRE(stats.phases.count("convert") == 1);
+    }
+
+    SECTION("parallel_sort")
+    {
+        parallel_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      std::less<int>(), 2);
+
+        REQUIRE(stats.scratch_bytes == length * 2 * sizeof(int));
+    }
+
+    SECTION("adaptive_sort")
+    {
+        adaptive_sort(values.begin(), values.end(), index.begin(), index.end(),
+                      std::less<int>());
+
+        REQUIRE(stats.scratch_bytes >= length * sizeof(std::pair<int, int>));
+        REQUIRE(stats.phases.count("scan") == 1);
+        REQUIRE(stats.phases.count("convert") == 1);
+    }
+
+    SECTION("few_unique_sort")
+    {
+        few_unique_sort(values.begin(), values.end(), index.begin(),
+                        index.end(), std::less<int>());
+
+        REQUIRE(stats.scratch_bytes == length * sizeof(std::pair<int, int>));
+    }
+
+    SECTION("few_unique_sort by counting")
+    {
+        for (auto & value : values)
+            value %= 4;
+        few_unique_sort(values.begin(), values.end(), index.begin(),
+                        index.end(), std::less<int>());
+
+        REQUIRE(stats.scratch_bytes ==
+                length * (sizeof(std::uint32_t) + sizeof(int)));
+    }
+
+    REQUIRE(std::is_sorted(values.begin(), values.end()));
+    for (const char * name : {"sort", "apply"})
+    {
+        REQUIRE(stats.phases.count(name) == 1);
+        REQUIRE(stats.phases.at(name).calls == 1);
+    }
+}
+
+/*
+ * Hidden test case which prints the counters of algorithms sorting the same
+ * values. Run it with `tests_instrumented "[.report]"`.
+ */
+TEST_CASE("Report instrumentation counters", "[.report]")
+{
+    constexpr std::size_t length = 1'000'000;
+    const auto values_orig = random_counted_values(length);
+    std::vector<int> index_orig(length);
+    std::iota(index_orig.begin(), index_orig.end(), 0);
+
+    auto report = [&values_orig, &index_orig](const char * name,
+                                              auto algorithm)
+    {
+        auto values = values_orig;
+        auto index = index_orig;
+
+        instrumentation::reset();
+        algorithm(values.begin(), values.end(),
+                  counted_iterator(index.begin()),
+                  counted_iterator(index.end()),
+                  counted_compare(std::less<int>()));
+        const auto & stats = instrumentation::current();
+
+        std::printf("%s: %llu comparisons, %llu moves, %llu swaps, "
+                    "%llu index dereferences, %llu scratch bytes\n",
+                    name, (unsigned long long)stats.comparisons,
+                    (unsigned long long)stats.moves,
+                    (unsigned long long)stats.swaps,
+                    (unsigned long long)stats.index_dereferences,
+                    (unsigned long long)stats.scratch_bytes);
+
+        for (const auto & [phase_name, phase] : stats.phases)
+        {
+            std::printf("    %-8s %10.3f ms", phase_name.c_str(),
+                        phase.time.count() / 1e6);
+            if (phase.cache_misses)
+                std::printf(", %llu cache misses, %llu branch misses",
+                            (unsigned long long)*phase.cache_misses,
+                            (unsigned long long)*phase.branch_misses);
+            std::printf("\n");
+        }
+    };
+
+    report("permutate_in_place_sort",
+           [](auto... args) { permutate_in_place_sort(args...); });
+    report("cycle_apply_sort",
+           [](auto... args) { cycle_apply_sort(args...); });
+    report("boost_index_apply_sort",
+           [](auto... args) { boost_index_apply_sort(args...); });
+    report("boost_index_apply_sort2",
+           [](auto... args) { boost_index_apply_sort2(args...); });
+    report("vector_pair_sort",
+           [](auto... args) { vector_pair_sort(args...); });
+}
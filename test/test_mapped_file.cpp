@@ -0,0 +1,127 @@
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include "argsort.hpp"
+#include "mapped_file.hpp"
+#include "temporary_file.hpp"
+#include "vector_pair_sort.hpp"
+
+using namespace indexsort;
+
+TEST_CASE("Test sorting mapped files")
+{
+    constexpr int vector_length = 10000;
+
+    auto rng_seed = Catch::getSeed();
+    std::mt19937 gen(rng_seed);
+
+    std::vector<int> values(vector_length);
+    std::uniform_int_distribution<> distrib(0, 999);
+    std::generate(values.begin(), values.end(),
+                  [&gen, &distrib]() { return distrib(gen); });
+
+    auto cmp = std::less<int>();
+
+    auto check_values(values);
+    std::vector<std::uint64_t> check_index(values.size());
+    stable_vector_pair_sort(check_values.begin(), check_values.end(),
+                            check_index.begin(), check_index.end(), cmp);
+
+    temporary_path value_path("values");
+    temporary_path index_path("index");
+    write_file(value_path.string(), values);
+
+    SECTION("Test argsort of read only file")
+    {
+        {
+            mapped_array<const int> mapped_values(value_path.string());
+            mapped_array<std::uint64_t> mapped_index(index_path.string(),
+                                                     mapped_values.size());
+
+            REQUIRE(mapped_values.size() == values.size());
+            REQUIRE(std::equal(mapped_values.begin(), mapped_values.end(),
+                               values.begin()));
+
+            stable_argsort(mapped_values.begin(), mapped_values.end(),
+                           mapped_index.begin(), mapped_index.end(), cmp);
+        }
+
+        REQUIRE(read_file<int>(value_path.string()) == values);
+        REQUIRE(read_file<std::uint64_t>(index_path.string()) == check_index);
+    }
+    SECTION("Test mapped boost index apply sort")
+    {
+        {
+            mapped_array<int> mapped_values(value_path.string());
+            mapped_array<std::uint64_t> mapped_index(index_path.string(),
+                                                     mapped_values.size());
+            std::iota(mapped_index.begin(), mapped_index.end(), 0);
+
+            mapped_boost_index_apply_sort(mapped_values, mapped_index, cmp);
+            mapped_values.sync();
+            mapped_index.sync();
+        }
+
+        auto sorted_values = read_file<int>(value_path.string());
+        auto sorted_index = read_file<std::uint64_t>(index_path.string());
+
+        REQUIRE(sorted_values == check_values);
+        for (int i = 0; i < vector_length; ++i)
+            REQUIRE(sorted_values[i] == values[sorted_index[i]]);
+    }
+    SECTION("Test mapped arrays of different length")
+    {
+        mapped_array<int> mapped_values(value_path.string());
+        mapped_array<std::uint64_t> mapped_index(index_path.string(), 1);
+
+        REQUIRE_THROWS_AS(
+          mapped_boost_index_apply_sort(mapped_values, mapped_index, cmp),
+          indexsort::length_mismatch_error);
+    }
+}
+
+TEST_CASE("Test mapped array")
+{
+    temporary_path path("array");
+
+    SECTION("Test empty file")
+    {
+        mapped_array<int> created(path.string(), 0);
+        REQUIRE(created.size() == 0);
+        REQUIRE(created.begin() == created.end());
+
+        mapped_array<const int> opened(path.string());
+        REQUIRE(opened.size() == 0);
+        opened.advise(access_pattern::sequential);
+    }
+    SECTION("Test moving")
+    {
+        mapped_array<int> created(path.string(), 3);
+        created[0] = 1;
+        created[1] = 2;
+        created[2] = 3;
+
+        mapped_array<int> moved(std::move(created));
+        REQUIRE(moved.size() == 3);
+        REQUIRE(moved[2] == 3);
+
+        moved.advise(access_pattern::random);
+        moved.sync();
+        REQUIRE(read_file<int>(path.string()) == std::vector<int>({1, 2, 3}));
+    }
+    SECTION("Test missing file")
+    {
+        temporary_path missing_directory("missing");
+        auto missing_file = (missing_directory.path / "file").string();
+
+        REQUIRE_THROWS_AS(mapped_array<const int>(missing_file),
+                          indexsort::io_error);
+        REQUIRE_THROWS_AS(mapped_array<int>(missing_file, 10),
+                          indexsort::io_error);
+    }
+}